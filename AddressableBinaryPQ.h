@@ -0,0 +1,298 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef ADDRESSABLEBINARYPQ_H
+#define ADDRESSABLEBINARYPQ_H
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Eecs281StaticPQ.h"
+
+// A binary heap whose elements can be found again after they are pushed.
+// pushHandle() returns a handle for the new element; update() changes its
+// priority in either direction and erase() removes it, each in O(log n),
+// instead of an O(n) updatePriorities().
+//
+// Each heap slot records the handle of its element, and a position index
+// maps every live handle to its slot.  fixUp() and fixDown() update the index
+// as they move elements, so a handle stays valid however the element moves.
+// A handle becomes invalid when its element is popped or erased, and may
+// then be handed out again by a later pushHandle().
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename STATS = NoStats>
+class AddressableBinaryPQ final
+    : public Eecs281StaticPQ<AddressableBinaryPQ<TYPE, COMP_FUNCTOR, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<AddressableBinaryPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+public:
+    using handle_type = std::size_t;
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit AddressableBinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // AddressableBinaryPQ()
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.  The elements get handles 0, 1, 2, ...
+    //              in range order.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    AddressableBinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+        for (InputIterator iter = start; iter != end; ++iter) {
+            position.push_back(data.size());
+            data.push_back(Entry{ *iter, data.size() });
+        }
+        updatePriorities();
+    } // AddressableBinaryPQ()
+
+
+    // Description: Destructor doesn't need any code, the vectors will be
+    //              destroyed automatically.
+    virtual ~AddressableBinaryPQ() {
+    } // ~AddressableBinaryPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant.  Handles
+    //              stay valid.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        for (std::size_t i = size() / 2; i-- > 0;) {
+            fixDown(i);
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        pushHandle(val);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: O(log(n))
+    virtual void push(TYPE &&val) {
+        pushHandle(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element and return its handle.
+    // Runtime: O(log(n))
+    handle_type pushHandle(const TYPE &val) {
+        return insert(val);
+    } // pushHandle()
+
+
+    // Description: Same as above, moving 'val' in.
+    // Runtime: O(log(n))
+    handle_type pushHandle(TYPE &&val) {
+        return insert(std::move(val));
+    } // pushHandle()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.  Its handle becomes invalid.
+    // Runtime: O(log(n))
+    virtual void pop() {
+        removeAt(0);
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it.
+    // Runtime: O(log(n))
+    virtual TYPE pop_value() {
+        TYPE val = std::move(data.front().val);
+        removeAt(0);
+        return val;
+    } // pop_value()
+
+
+    // Description: Replace the element behind 'handle' with 'newVal', which
+    //              may be more or less extreme than the old value.
+    // Runtime: O(log(n))
+    void update(handle_type handle, const TYPE &newVal) {
+        const std::size_t ind = position[handle];
+        const bool moreExtreme = this->countedCompare(data[ind].val, newVal);
+        data[ind].val = newVal;
+        if (moreExtreme)
+            fixUp(ind);
+        else
+            fixDown(ind);
+    } // update()
+
+
+    // Description: Remove the element behind 'handle' from the heap.
+    // Runtime: O(log(n))
+    void erase(handle_type handle) {
+        removeAt(position[handle]);
+    } // erase()
+
+
+    // Description: The element behind a valid handle.
+    // Runtime: O(1)
+    const TYPE &get(handle_type handle) const {
+        return data[position[handle]].val;
+    } // get()
+
+
+    // Description: Return true if 'handle' belongs to an element still in the
+    //              heap (one that was not popped or erased since).
+    // Runtime: O(1)
+    bool contains(handle_type handle) const {
+        return handle < position.size() && position[handle] != NPOS;
+    } // contains()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front().val;
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+protected:
+    // Description: Add a batch of elements, choosing between k sift-ups and
+    //              one bottom-up rebuild as BinaryPQ does.
+    // Runtime: O(min(k log(n + k), n + k)) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        const std::size_t oldSize = size();
+        const std::size_t total = oldSize + batch.size();
+        data.reserve(total);
+        for (TYPE &val : batch) {
+            const handle_type handle = newHandle();
+            position[handle] = data.size();
+            data.push_back(Entry{ std::move(val), handle });
+        }
+
+        std::size_t levels = 0;
+        for (std::size_t n = total; n > 1; n /= 2)
+            ++levels;
+        if (batch.size() * levels > 2 * total) {
+            updatePriorities();
+        }
+        else {
+            for (std::size_t i = oldSize; i < total; ++i)
+                fixUp(i);
+        }
+    } // pushBatch()
+
+
+private:
+    static constexpr std::size_t NPOS = std::size_t(-1);
+
+    // A heap slot: the element and the handle it was pushed under.
+    struct Entry {
+        TYPE val;
+        handle_type handle;
+    };
+
+    std::vector<Entry> data;
+    // position[handle] is the slot of that handle's element, or NPOS.
+    std::vector<std::size_t> position;
+    // Handles whose elements were popped or erased, for reuse.
+    std::vector<handle_type> freeHandles;
+
+    handle_type newHandle() {
+        if (freeHandles.empty()) {
+            position.push_back(NPOS);
+            return position.size() - 1;
+        }
+        handle_type handle = freeHandles.back();
+        freeHandles.pop_back();
+        return handle;
+    } // newHandle()
+
+    template<typename VALUE>
+    handle_type insert(VALUE &&val) {
+        const handle_type handle = newHandle();
+        position[handle] = data.size();
+        data.push_back(Entry{ std::forward<VALUE>(val), handle });
+        fixUp(data.size() - 1);
+        return handle;
+    } // insert()
+
+    // Remove the element in slot 'ind': fill the slot from the back, then
+    // move that element whichever way it has to go.
+    void removeAt(std::size_t ind) {
+        position[data[ind].handle] = NPOS;
+        freeHandles.push_back(data[ind].handle);
+        if (ind + 1 == data.size()) {
+            data.pop_back();
+            return;
+        }
+        data[ind] = std::move(data.back());
+        this->stats().onMove();
+        data.pop_back();
+        position[data[ind].handle] = ind;
+        if (ind > 0 && this->countedCompare(data[(ind - 1) / 2].val, data[ind].val))
+            fixUp(ind);
+        else
+            fixDown(ind);
+    } // removeAt()
+
+    // Move the element at ind up until its parent is at least as extreme,
+    // keeping 'position' in step with every slot written.
+    void fixUp(std::size_t ind) {
+        Entry entry = std::move(data[ind]);
+        std::size_t depth = 0;
+        while (ind > 0) {
+            std::size_t parent = (ind - 1) / 2;
+            if (!this->countedCompare(data[parent].val, entry.val))
+                break;
+            data[ind] = std::move(data[parent]);
+            position[data[ind].handle] = ind;
+            this->stats().onMove();
+            ind = parent;
+            ++depth;
+        }
+        position[entry.handle] = ind;
+        data[ind] = std::move(entry);
+        this->stats().onSift(depth);
+    } // fixUp()
+
+    // Move the element at ind down until neither child is more extreme,
+    // keeping 'position' in step with every slot written.
+    void fixDown(std::size_t ind) {
+        const std::size_t n = size();
+        Entry entry = std::move(data[ind]);
+        std::size_t depth = 0;
+        for (std::size_t child = 2 * ind + 1; child < n; child = 2 * ind + 1) {
+            if (child + 1 < n && this->countedCompare(data[child].val, data[child + 1].val))
+                ++child;
+            if (!this->countedCompare(entry.val, data[child].val))
+                break;
+            data[ind] = std::move(data[child]);
+            position[data[ind].handle] = ind;
+            this->stats().onMove();
+            ind = child;
+            ++depth;
+        }
+        position[entry.handle] = ind;
+        data[ind] = std::move(entry);
+        this->stats().onSift(depth);
+    } // fixDown()
+}; // AddressableBinaryPQ
+
+#endif // ADDRESSABLEBINARYPQ_H
@@ -5,13 +5,45 @@
 
 
 #include <algorithm>
-#include "Eecs281PQ.h"
+#include <cassert>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "DirtySet.h"
+#include "Eecs281StaticPQ.h"
+#include "Snapshot.h"
+
+// How BinaryPQ sifts an element down (in pop() and every rebuild).
+//
+// TopDownSift compares the two children, then the element against the more
+// extreme one, and stops as soon as the element is at least as extreme:
+// two comparisons per level.
+//
+// BottomUpSift (Wegener's bottom-up heapsort) walks the path of more extreme
+// children all the way to a leaf, moving each one up a level, then sifts the
+// element up from the leaf's hole.  An element sifted down from the root
+// usually belongs near the bottom, so the walk back up is short: about one
+// comparison per level, at the cost of a few extra moves.  It pays off when
+// comparisons are expensive (strings, indirection, counting comparators).
+struct TopDownSift {};
+struct BottomUpSift {};
+
 
 // A specialized version of the 'heap' ADT implemented as a binary heap.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// SIFT is TopDownSift or BottomUpSift, see above.
+// STATS is a statistics policy from PQStats.h.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename SIFT = TopDownSift,
+         typename STATS = NoStats>
+class BinaryPQ final
+    : public Eecs281StaticPQ<BinaryPQ<TYPE, COMP_FUNCTOR, SIFT, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    static_assert(std::is_same<SIFT, TopDownSift>::value || std::is_same<SIFT, BottomUpSift>::value,
+                  "BinaryPQ sifts with TopDownSift or BottomUpSift");
+
     // This is a way to refer to the base class object.
-    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+    using BaseClass = Eecs281StaticPQ<BinaryPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
 
 public:
     // Description: Construct an empty heap with an optional comparison functor.
@@ -44,22 +76,84 @@ public:
     //              'rebuilds' the heap by fixing the heap invariant.
     // Runtime: O(n)
     virtual void updatePriorities() {
-        for (int i = int(data.size()) - 1; i >= 0; i--) {
+        dirty.clear();
+        for (std::size_t i = size() / 2; i-- > 0;) {
             fixDown(i);
         }
     } // updatePriorities()
 
 
+    // Description: Record that the priority of 'val', an element in the heap,
+    //              has changed (for instance, the value a pointer element
+    //              points to).  Nothing moves until updateDirty().  The
+    //              element is found again by identity (see DirtySet.h), so
+    //              TYPE is usually a pointer or an index.
+    // Runtime: O(1)
+    void markDirty(const TYPE &val) {
+        dirty.add(val);
+    } // markDirty()
+
+
+    // Description: Repair the heap after the priorities of the elements given
+    //              to markDirty() changed.  One pass over the array finds them;
+    //              they and their ancestors are then sifted down in decreasing
+    //              index order, as updatePriorities() does for every index.
+    //              Past 1 / DIRTY_REBUILD of the heap, updatePriorities() is
+    //              used instead.
+    // Runtime: O(n + d log(n)^2) for d dirty elements.
+    void updateDirty() {
+        if (dirty.empty())
+            return;
+        if (dirty.size() * DIRTY_REBUILD > size()) {
+            updatePriorities();
+            return;
+        }
+        dirty.prepare();
+        std::vector<std::size_t> repair;
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (!dirty.contains(data[i]))
+                continue;
+            // i and every ancestor; shared ancestors are merged below.
+            for (std::size_t ind = i;; ind = (ind - 1) / 2) {
+                repair.push_back(ind);
+                if (ind == 0)
+                    break;
+            }
+        } // for
+        dirty.clear();
+        std::sort(repair.begin(), repair.end());
+        repair.erase(std::unique(repair.begin(), repair.end()), repair.end());
+        for (auto it = repair.rbegin(); it != repair.rend(); ++it)
+            fixDown(*it);
+    } // updateDirty()
+
+
     // Description: Add a new element to the heap.
     // Runtime: O(log(n))
     // TODO: when you implement this function, uncomment the parameter names.
     virtual void push(const TYPE &val) {
         data.push_back(val);
-        fixUp(int(size())-1);
-        // TODO: Implement this function.
+        fixUp(size() - 1);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: O(log(n))
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        fixUp(size() - 1);
     } // push()
 
 
+    // Description: Construct a new element in place at the bottom of the heap.
+    // Runtime: O(log(n))
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        fixUp(size() - 1);
+    } // emplace()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
@@ -67,15 +161,49 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: O(log(n))
     virtual void pop() {
-        if (!empty()) {
-            std::swap(data.front(), data.back());
+        if (size() > 1) {
+            data.front() = std::move(data.back());
+            this->stats().onMove();
             data.pop_back();
-            fixDown(0);
+            if constexpr (std::is_same<SIFT, BottomUpSift>::value)
+                fixDownBottomUp(0, false);
+            else
+                fixDown(0);
+        }
+        else {
+            data.clear();
         }
-        // TODO: Implement this function.
     } // pop()
 
 
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the heap.
+    // Runtime: O(log(n))
+    virtual TYPE pop_value() {
+        TYPE val = std::move(data.front());
+        pop();
+        return val;
+    } // pop_value()
+
+
+    // Description: Move every element of 'other' into this heap and leave
+    //              'other' empty.  Uses the same append-then-sift-or-rebuild
+    //              choice as push_range(); merging into an empty heap just
+    //              takes other's vector.  Both heaps must use equivalent
+    //              comparison functors.
+    // Runtime: O(min(m log(n + m), n + m)) for m elements in other.
+    void merge(BinaryPQ &&other) {
+        if (&other == this)
+            return;
+        if (empty())
+            data.swap(other.data);
+        else
+            pushBatch(other.data);
+        other.data.clear();
+        dirty.merge(other.dirty);
+    } // merge()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the heap.  This should be a reference for speed.  It MUST be
     //              const because we cannot allow it to be modified, as that
@@ -100,6 +228,14 @@ public:
     } // size()
 
 
+    // Description: Make room for 'n' elements, so that pushes up to that
+    //              size never reallocate.
+    // Runtime: O(n)
+    void reserve(std::size_t n) {
+        data.reserve(n);
+    } // reserve()
+
+
     // Description: Return true if the heap is empty.
     // Runtime: O(1)
     virtual bool empty() const {
@@ -110,6 +246,127 @@ public:
     } // empty()
 
 
+    // Description: Write the heap array as is to a Heap image at 'path' (see
+    //              Snapshot.h).  TYPE must be trivially copyable.
+    // Runtime: O(n)
+    void snapshot(const std::string &path) const {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots write elements as raw bytes");
+        SnapshotWriter out{ path, SnapshotFormat::Heap, sizeof(TYPE), size() };
+        out.write(data.data(), size() * sizeof(TYPE));
+        out.finish();
+    } // snapshot()
+
+
+    // Description: Replace the contents with the Heap image at 'path', taking
+    //              the array as the heap without rebuilding it.  The image
+    //              must come from a heap with the same order; debug builds
+    //              check the heap invariant.
+    // Runtime: O(n), one copy out of the mapped image.
+    void restore(const std::string &path) {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots read elements as raw bytes");
+        static_assert(alignof(TYPE) <= sizeof(SnapshotHeader), "snapshot elements follow the header");
+        SnapshotImage image{ path, SnapshotFormat::Heap, sizeof(TYPE) };
+        if (image.extraBytes() != 0)
+            image.malformed("has trailing data");
+        const TYPE *elts = image.elements<TYPE>();
+        data.assign(elts, elts + image.count());
+        dirty.clear();
+        this->stats().onMove(data.size());
+        assert(std::is_heap(data.begin(), data.end(), this->compare) && "snapshot is not a heap in this order");
+    } // restore()
+
+
+protected:
+    // Description: Add a batch of elements.  Appending the batch and running
+    //              the O(n + k) bottom-up rebuild beats k sift-ups of up to
+    //              log(n + k) levels each once the batch is a sizeable
+    //              fraction of the heap, so pick whichever bound is lower.
+    // Runtime: O(min(k log(n + k), n + k)) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        const std::size_t oldSize = size();
+        const std::size_t total = oldSize + batch.size();
+        data.insert(data.end(), std::make_move_iterator(batch.begin()),
+                    std::make_move_iterator(batch.end()));
+
+        std::size_t levels = 0;
+        for (std::size_t n = total; n > 1; n /= 2)
+            ++levels;
+        if (batch.size() * levels > 2 * total) {
+            updatePriorities();
+        }
+        else {
+            for (std::size_t i = oldSize; i < total; ++i)
+                fixUp(i);
+        }
+    } // pushBatch()
+
+
+    // Description: Partial extraction of the k most extreme elements.  They
+    //              form a subtree containing the root, which is found without
+    //              disturbing the heap by expanding a frontier of candidate
+    //              indices.  The holes they leave are filled from the end of
+    //              the array and repaired with one bottom-up pass over that
+    //              subtree, instead of k full-height sifts from the root.
+    // Runtime: O(k log(k) + k log(n / k))
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        const std::size_t n = size();
+        if (k <= 1) {
+            if (k == 1)
+                batch.push_back(pop_value());
+            return;
+        }
+        batch.reserve(batch.size() + k);
+        if (k == n) {
+            std::sort_heap(data.begin(), data.end(), this->countedComparator());
+            batch.insert(batch.end(), std::make_move_iterator(data.rbegin()),
+                         std::make_move_iterator(data.rend()));
+            data.clear();
+            return;
+        }
+
+        // Select: a max-frontier of indices, seeded with the root.
+        auto frontierComp = [this](std::size_t a, std::size_t b) {
+            return this->countedCompare(data[a], data[b]);
+        };
+        std::vector<std::size_t> frontier{ 0 };
+        std::vector<std::size_t> holes;
+        holes.reserve(k);
+        while (holes.size() < k) {
+            std::pop_heap(frontier.begin(), frontier.end(), frontierComp);
+            std::size_t ind = frontier.back();
+            frontier.pop_back();
+            for (std::size_t child = 2 * ind + 1; child <= 2 * ind + 2 && child < n; ++child) {
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), frontierComp);
+            }
+            batch.push_back(std::move(data[ind]));
+            holes.push_back(ind);
+        }
+
+        // Fill the holes below the new size with the surviving elements from
+        // the tail; every hole's ancestors are holes too, so the survivors
+        // outside the subtree still sit on top of valid heaps.
+        std::sort(holes.begin(), holes.end());
+        const std::size_t newSize = n - k;
+        std::size_t tail = n;
+        for (std::size_t hole : holes) {
+            if (hole >= newSize)
+                break;
+            do {
+                --tail;
+            } while (std::binary_search(holes.begin(), holes.end(), tail));
+            data[hole] = std::move(data[tail]);
+            this->stats().onMove();
+        }
+        data.erase(data.begin() + std::ptrdiff_t(newSize), data.end());
+
+        for (auto it = holes.rbegin(); it != holes.rend(); ++it) {
+            if (*it < newSize)
+                fixDown(*it);
+        }
+    } // popBatch()
+
+
 private:
     // Note: This vector *must* be used for your heap implementation.
     std::vector<TYPE> data;
@@ -120,27 +377,94 @@ private:
     // TODO: Add any additional member functions or data you require here.
     //       For instance, you might add fixUp() and fixDown().
 
-    void fixUp(int ind) {
-        if (this->compare(data[((ind - 1) / 2)], data[ind])) {
-            std::swap(data[((ind - 1) / 2)], data[ind]);
-            if (ind > 0) {
-                fixUp(((ind - 1) / 2));
-            }
+    // Elements given to markDirty() since the last repair.
+    DirtySet<TYPE> dirty;
+    // updateDirty() rebuilds the whole heap once more than 1 / DIRTY_REBUILD
+    // of it is dirty.  The ancestors of scattered indices cover the upper
+    // levels quickly, and sifting those down goes deep where the bottom-up
+    // rebuild mostly sifts near the leaves; measured, the two cost the same
+    // at about 1 / 400.
+    static constexpr std::size_t DIRTY_REBUILD = 400;
+
+    // Move the element at ind up until its parent is at least as extreme.
+    // The element is held aside and parents are moved down into the hole.
+    void fixUp(std::size_t ind) {
+        TYPE val = std::move(data[ind]);
+        std::size_t depth = 0;
+        while (ind > 0) {
+            std::size_t parent = (ind - 1) / 2;
+            if (!this->countedCompare(data[parent], val))
+                break;
+            data[ind] = std::move(data[parent]);
+            this->stats().onMove();
+            ind = parent;
+            ++depth;
+        }
+        data[ind] = std::move(val);
+        this->stats().onSift(depth);
+    } // fixUp()
+
+    // Move the element at ind down until neither child is more extreme,
+    // moving the more extreme child up into the hole at each level.
+    void fixDown(std::size_t ind) {
+        if constexpr (std::is_same<SIFT, BottomUpSift>::value) {
+            fixDownBottomUp(ind, true);
+            return;
         }
-    }
-    void fixDown(int ind) {
-        int extr = ind;
-        if ((((2 * ind) + 1) < int(size())) && this->compare(data[ind], data[((2 * ind) + 1)])) {
-            extr = ((2 * ind) + 1);
+        const std::size_t n = size();
+        TYPE val = std::move(data[ind]);
+        std::size_t depth = 0;
+        for (std::size_t child = 2 * ind + 1; child < n; child = 2 * ind + 1) {
+            if (child + 1 < n && this->countedCompare(data[child], data[child + 1]))
+                ++child;
+            if (!this->countedCompare(val, data[child]))
+                break;
+            data[ind] = std::move(data[child]);
+            this->stats().onMove();
+            ind = child;
+            ++depth;
         }
-        if ((((2 * ind) + 2) < int(size())) && this->compare(data[extr], data[((2 * ind) + 2)])) {
-            extr = ((2 * ind) + 2);
+        data[ind] = std::move(val);
+        this->stats().onSift(depth);
+    } // fixDown()
+
+    // The same, bottom-up: move the more extreme child up at every level
+    // down to a leaf without looking at the element, then move the element
+    // up from that hole, moving the path back down behind it, until its
+    // parent is at least as extreme.  The element never rises above 'ind'.
+    // With 'checkFirst' the first level is top-down, so an element already in
+    // place costs two comparisons instead of a walk to the leaves; rebuilds,
+    // which mostly find elements in place, want that, and pop() does not.
+    void fixDownBottomUp(std::size_t ind, bool checkFirst) {
+        const std::size_t n = size();
+        const std::size_t start = ind;
+        TYPE val = std::move(data[ind]);
+        std::size_t depth = 0;
+        for (std::size_t child = 2 * ind + 1; child < n; child = 2 * ind + 1) {
+            if (child + 1 < n && this->countedCompare(data[child], data[child + 1]))
+                ++child;
+            if (checkFirst) {
+                checkFirst = false;
+                if (!this->countedCompare(val, data[child]))
+                    break;
+            }
+            data[ind] = std::move(data[child]);
+            this->stats().onMove();
+            ind = child;
+            ++depth;
         }
-        if (extr != ind) {
-            std::swap(data[extr], data[ind]);
-            fixDown(extr);
+        while (ind > start) {
+            std::size_t parent = (ind - 1) / 2;
+            if (!this->countedCompare(data[parent], val))
+                break;
+            data[ind] = std::move(data[parent]);
+            this->stats().onMove();
+            ind = parent;
+            --depth;
         }
-    }
+        data[ind] = std::move(val);
+        this->stats().onSift(depth);
+    } // fixDownBottomUp()
     
 }; // BinaryPQ
 
@@ -0,0 +1,358 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef BUCKETPQ_H
+#define BUCKETPQ_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Eecs281StaticPQ.h"
+#include "KeyOf.h"
+
+// Which end of the key range a key-ordered engine pops first.  The engines
+// that order by key follow Eecs281PQ: with std::less the LARGEST key is most
+// extreme, with std::greater the SMALLEST.  Specialize this for other
+// comparison functors that order like std::greater.
+template<typename COMP_FUNCTOR>
+struct pops_lowest_key : std::false_type {};
+
+template<typename T>
+struct pops_lowest_key<std::greater<T>> : std::true_type {};
+
+
+// Selects the calendar-queue mode of BucketPQ: 'buckets' buckets, each
+// covering 'width' consecutive priorities, reused cyclically like the days
+// of a calendar year.
+struct BucketCalendar {
+    std::size_t buckets;
+    std::uint64_t width;
+};
+
+
+// A bucket queue for integral priorities.  Elements sit in one bucket per
+// priority, FIFO within a bucket, and a two-level bitmap of the non-empty
+// buckets finds the next one with a find-first-set instead of comparing
+// elements: push() and pop() are O(1) and the comparison functor is never
+// called.  KEY_OF maps an element to its priority (see KeyOf.h).
+//
+// Direct mode, BucketPQ(numPriorities): priorities are 0 .. numPriorities-1
+// (checked with assert()).  With COMP_FUNCTOR = std::less the highest
+// priority pops first, with std::greater the lowest (see pops_lowest_key).
+//
+// Calendar mode, BucketPQ(BucketCalendar{ buckets, width }): for wide ranges
+// whose live priorities are clustered, e.g. timestamps.  Priority p goes to
+// bucket (p / width) % buckets, and each bucket is kept sorted (still FIFO
+// among equal priorities).  pop() walks forward from the current bucket to
+// the first one whose front falls inside that bucket's window of the current
+// "year"; after a whole year with nothing due it jumps straight to the most
+// extreme element.  With the width near the typical gap between priorities,
+// push() and pop() are O(1) on average (Brown, "Calendar Queues", CACM 1988).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename KEY_OF = IdentityKey, typename STATS = NoStats>
+class BucketPQ final
+    : public Eecs281StaticPQ<BucketPQ<TYPE, COMP_FUNCTOR, KEY_OF, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<BucketPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+    using RawKey = std::decay_t<decltype(std::declval<KEY_OF>()(std::declval<const TYPE &>()))>;
+    static_assert(std::is_integral<RawKey>::value, "BucketPQ needs integral priorities");
+
+public:
+    // Description: Construct an empty direct-mode queue for priorities
+    //              0 .. numPriorities-1.
+    // Runtime: O(numPriorities)
+    explicit BucketPQ(std::size_t numPriorities = 1024, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                      KEY_OF keyFunc = KEY_OF()) :
+        BaseClass{ comp }, keyOf{ keyFunc } {
+        allocate(numPriorities);
+    } // BucketPQ()
+
+
+    // Description: Construct an empty calendar-mode queue.
+    // Runtime: O(calendar.buckets)
+    explicit BucketPQ(BucketCalendar calendar, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                      KEY_OF keyFunc = KEY_OF()) :
+        BaseClass{ comp }, keyOf{ keyFunc }, width{ calendar.width } {
+        assert(calendar.width > 0);
+        allocate(calendar.buckets);
+    } // BucketPQ()
+
+
+    // Description: Construct a direct-mode queue out of an iterator range.
+    // Runtime: O(n + numPriorities)
+    template<typename InputIterator>
+    BucketPQ(InputIterator start, InputIterator end, std::size_t numPriorities = 1024,
+             COMP_FUNCTOR comp = COMP_FUNCTOR(), KEY_OF keyFunc = KEY_OF()) :
+        BaseClass{ comp }, keyOf{ keyFunc } {
+        allocate(numPriorities);
+        for (InputIterator iter = start; iter != end; ++iter)
+            push(*iter);
+    } // BucketPQ()
+
+
+    // Description: Destructor doesn't need any code, the buckets will be
+    //              destroyed automatically.
+    virtual ~BucketPQ() {
+    } // ~BucketPQ()
+
+
+    // Description: Re-bucket every element by its current priority.  Elements
+    //              that shared a priority before keep their order; the rest
+    //              come out in the order of their old buckets, which is not
+    //              push order, so FIFO among equal priorities is lost.
+    // Runtime: O(n + number of buckets)
+    virtual void updatePriorities() {
+        std::vector<TYPE> all;
+        all.reserve(numElements);
+        for (std::size_t b = nextNonEmpty(0); b != NPOS; b = nextNonEmpty(b + 1)) {
+            Bucket &bucket = buckets[b];
+            all.insert(all.end(), std::make_move_iterator(bucket.items.begin() + std::ptrdiff_t(bucket.head)),
+                       std::make_move_iterator(bucket.items.end()));
+            bucket.items.clear();
+            bucket.head = 0;
+        }
+        std::fill(words.begin(), words.end(), 0);
+        std::fill(summary.begin(), summary.end(), 0);
+        numElements = 0;
+        for (TYPE &val : all)
+            push(std::move(val));
+    } // updatePriorities()
+
+
+    // Description: Add a new element.
+    // Runtime: O(1); in calendar mode, plus the elements of its bucket with
+    //          a later priority, which move up one slot.
+    virtual void push(const TYPE &val) {
+        place(val);
+    } // push()
+
+
+    // Description: Add a new element, moving it in.
+    // Runtime: as above.
+    virtual void push(TYPE &&val) {
+        place(std::move(val));
+    } // push()
+
+
+    // Description: Remove the most extreme element: the first one pushed
+    //              among those of the most extreme priority.
+    // Runtime: O(1) in direct mode; O(1) on average in calendar mode.
+    virtual void pop() {
+        const std::size_t b = frontBucket();
+        Bucket &bucket = buckets[b];
+        if (++bucket.head == bucket.items.size()) {
+            bucket.items.clear();
+            bucket.head = 0;
+            clearBit(b);
+        }
+        else if (bucket.head >= 64 && 2 * bucket.head >= bucket.items.size()) {
+            // Drop the popped prefix once it is half of the bucket.
+            this->stats().onMove(bucket.items.size() - bucket.head);
+            bucket.items.erase(bucket.items.begin(),
+                               bucket.items.begin() + std::ptrdiff_t(bucket.head));
+            bucket.head = 0;
+        }
+        --numElements;
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it.
+    // Runtime: as pop().
+    virtual TYPE pop_value() {
+        Bucket &bucket = buckets[frontBucket()];
+        TYPE val = std::move(bucket.items[bucket.head]);
+        pop();
+        return val;
+    } // pop_value()
+
+
+    // Description: Return the most extreme element.
+    // Runtime: as pop().
+    virtual const TYPE &top() const {
+        const Bucket &bucket = buckets[frontBucket()];
+        return bucket.items[bucket.head];
+    } // top()
+
+
+    // Description: Get the number of elements in the queue.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return numElements;
+    } // size()
+
+
+    // Description: Return true if the queue is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return numElements == 0;
+    } // empty()
+
+
+private:
+    static constexpr std::size_t NPOS = std::size_t(-1);
+
+    // A FIFO: elements before 'head' have been popped.
+    struct Bucket {
+        std::vector<TYPE> items;
+        std::size_t head = 0;
+    };
+
+    std::vector<Bucket> buckets;
+    // Bit i of words[i / 64] is set when buckets[i] is non-empty, and bit w
+    // of summary[w / 64] when words[w] is non-zero.
+    std::vector<std::uint64_t> words;
+    std::vector<std::uint64_t> summary;
+    std::size_t numElements = 0;
+    KEY_OF keyOf;
+    // Calendar mode only (width 0 means direct mode): the bucket pop()
+    // looks at first, and the first rank of its window.  Every element's
+    // rank is at least curStart.
+    std::uint64_t width = 0;
+    mutable std::size_t curBucket = 0;
+    mutable std::uint64_t curStart = 0;
+
+    void allocate(std::size_t numBuckets) {
+        assert(numBuckets > 0);
+        buckets.resize(numBuckets);
+        words.assign((numBuckets + 63) / 64, 0);
+        summary.assign((words.size() + 63) / 64, 0);
+    } // allocate()
+
+    // The priority as a rank: rank 0 pops first.  Direct mode uses the rank
+    // as the bucket index.
+    std::uint64_t rankOf(const TYPE &val) const {
+        const RawKey raw = keyOf(val);
+        if (width == 0) {
+            const std::uint64_t key = std::uint64_t(raw);
+            assert(key < buckets.size() && "BucketPQ priority out of range");
+            return pops_lowest_key<COMP_FUNCTOR>::value ? key : buckets.size() - 1 - key;
+        }
+        // Calendar mode: any key, in an unsigned order-preserving form.
+        std::uint64_t key = std::uint64_t(raw);
+        if (std::is_signed<RawKey>::value)
+            key ^= std::uint64_t(1) << 63;
+        return pops_lowest_key<COMP_FUNCTOR>::value ? key : ~key;
+    } // rankOf()
+
+    template<typename VALUE>
+    void place(VALUE &&val) {
+        const std::uint64_t rank = rankOf(val);
+        std::size_t b;
+        if (width == 0) {
+            b = std::size_t(rank);
+            buckets[b].items.push_back(std::forward<VALUE>(val));
+        }
+        else {
+            b = std::size_t((rank / width) % buckets.size());
+            if (numElements == 0 || rank < curStart) {
+                curBucket = b;
+                curStart = rank - rank % width;
+            }
+            // Keep the bucket sorted by rank, after any equal ranks.
+            std::vector<TYPE> &items = buckets[b].items;
+            auto pos = std::upper_bound(items.begin() + std::ptrdiff_t(buckets[b].head), items.end(), rank,
+                                        [this](std::uint64_t r, const TYPE &other) {
+                                            return r < rankOf(other);
+                                        });
+            this->stats().onMove(std::size_t(items.end() - pos));
+            items.insert(pos, std::forward<VALUE>(val));
+        }
+        setBit(b);
+        ++numElements;
+    } // place()
+
+    // The bucket holding the most extreme element; the queue must not be empty.
+    std::size_t frontBucket() const {
+        if (width == 0)
+            return nextNonEmpty(0);
+        settle();
+        return curBucket;
+    } // frontBucket()
+
+    // Calendar mode: advance curBucket to the first bucket whose front is
+    // due in its window, skipping runs of empty buckets through the bitmap.
+    void settle() const {
+        const std::size_t n = buckets.size();
+        std::size_t b = curBucket;
+        std::uint64_t start = curStart;
+        for (std::size_t steps = 0; steps < n;) {
+            std::size_t skip = 1;
+            if (isSet(b)) {
+                // Ranks are never below 'start', so this cannot overflow.
+                if (rankOf(buckets[b].items[buckets[b].head]) - start < width) {
+                    curBucket = b;
+                    curStart = start;
+                    return;
+                }
+            }
+            else {
+                std::size_t next = nextNonEmpty(b);
+                skip = (next == NPOS) ? n - b : next - b;
+            }
+            steps += skip;
+            start += skip * width;
+            b += skip;
+            if (b == n)
+                b = 0;
+        }
+
+        // Nothing due within a whole year: jump to the smallest rank.
+        std::size_t best = NPOS;
+        std::uint64_t bestRank = 0;
+        for (std::size_t i = nextNonEmpty(0); i != NPOS; i = nextNonEmpty(i + 1)) {
+            std::uint64_t rank = rankOf(buckets[i].items[buckets[i].head]);
+            if (best == NPOS || rank < bestRank) {
+                best = i;
+                bestRank = rank;
+            }
+        }
+        curBucket = best;
+        curStart = bestRank - bestRank % width;
+    } // settle()
+
+    bool isSet(std::size_t b) const {
+        return (words[b / 64] >> (b % 64)) & 1;
+    } // isSet()
+
+    void setBit(std::size_t b) {
+        words[b / 64] |= std::uint64_t(1) << (b % 64);
+        summary[b / 4096] |= std::uint64_t(1) << ((b / 64) % 64);
+    } // setBit()
+
+    void clearBit(std::size_t b) {
+        words[b / 64] &= ~(std::uint64_t(1) << (b % 64));
+        if (words[b / 64] == 0)
+            summary[b / 4096] &= ~(std::uint64_t(1) << ((b / 64) % 64));
+    } // clearBit()
+
+    // The first non-empty bucket at or after 'from', or NPOS.
+    std::size_t nextNonEmpty(std::size_t from) const {
+        std::size_t w = from / 64;
+        if (w >= words.size())
+            return NPOS;
+        std::uint64_t bits = words[w] & (~std::uint64_t(0) << (from % 64));
+        if (bits != 0)
+            return w * 64 + std::size_t(__builtin_ctzll(bits));
+        ++w;
+        if (w >= words.size())
+            return NPOS;
+        std::size_t s = w / 64;
+        std::uint64_t summaryBits = summary[s] & (~std::uint64_t(0) << (w % 64));
+        while (summaryBits == 0) {
+            if (++s == summary.size())
+                return NPOS;
+            summaryBits = summary[s];
+        }
+        w = s * 64 + std::size_t(__builtin_ctzll(summaryBits));
+        return w * 64 + std::size_t(__builtin_ctzll(words[w]));
+    } // nextNonEmpty()
+}; // BucketPQ
+
+#endif // BUCKETPQ_H
@@ -0,0 +1,62 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef CACHELINEALLOCATOR_H
+#define CACHELINEALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+// Size of a cache line on every target we care about.
+static const std::size_t CACHE_LINE_BYTES = 64;
+
+
+// A std::allocator replacement for array-based heaps whose root lives at
+// index 0 and whose children start at index 1.  The returned storage is
+// shifted so that element 1 (not element 0) starts on a cache line boundary.
+// With children of node i stored at [D*i + 1, D*i + D], the sibling groups
+// then tile the lines from there: when 64 % (D*sizeof(TYPE)) == 0 every
+// group lies inside one line, and when D*sizeof(TYPE) is a multiple of 64
+// every group starts on one.
+template<typename TYPE>
+class CacheLineAllocator {
+public:
+    using value_type = TYPE;
+
+    CacheLineAllocator() noexcept {}
+
+    template<typename OTHER>
+    CacheLineAllocator(const CacheLineAllocator<OTHER> &) noexcept {}
+
+
+    // Description: Allocate room for n elements, with element 1 line-aligned.
+    // Runtime: O(1)
+    TYPE *allocate(std::size_t n) {
+        void *raw = ::operator new(n * sizeof(TYPE) + shift(),
+                                   std::align_val_t{ CACHE_LINE_BYTES });
+        return reinterpret_cast<TYPE *>(static_cast<char *>(raw) + shift());
+    } // allocate()
+
+
+    // Description: Release storage obtained from allocate().
+    // Runtime: O(1)
+    void deallocate(TYPE *ptr, std::size_t) noexcept {
+        ::operator delete(reinterpret_cast<char *>(ptr) - shift(),
+                          std::align_val_t{ CACHE_LINE_BYTES });
+    } // deallocate()
+
+
+    // All instances are interchangeable; there is no per-allocator state.
+    template<typename OTHER>
+    bool operator==(const CacheLineAllocator<OTHER> &) const noexcept { return true; }
+    template<typename OTHER>
+    bool operator!=(const CacheLineAllocator<OTHER> &) const noexcept { return false; }
+
+private:
+    // Number of bytes to skip so that (start + sizeof(TYPE)) is line-aligned.
+    // Always a multiple of alignof(TYPE), since both 64 and sizeof(TYPE) are.
+    static constexpr std::size_t shift() {
+        return (CACHE_LINE_BYTES - sizeof(TYPE) % CACHE_LINE_BYTES) % CACHE_LINE_BYTES;
+    } // shift()
+}; // CacheLineAllocator
+
+#endif // CACHELINEALLOCATOR_H
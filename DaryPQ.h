@@ -0,0 +1,234 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef DARYPQ_H
+#define DARYPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include "Eecs281StaticPQ.h"
+#include "CacheLineAllocator.h"
+
+// A specialized version of the 'heap' ADT implemented as a d-ary heap.
+// The children of index i are stored contiguously at [ARITY*i + 1, ARITY*i + ARITY],
+// and the storage is laid out (see CacheLineAllocator) so that the groups of
+// siblings tile cache lines from index 1.  When 64 % (ARITY*sizeof(TYPE)) == 0
+// each group lies inside one line, so fixDown() touches one cache line per
+// level, and the tree is log(ARITY) times shallower than a binary heap.
+// STATS is a statistics policy from PQStats.h.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t ARITY = 4,
+         typename STATS = NoStats>
+class DaryPQ final
+    : public Eecs281StaticPQ<DaryPQ<TYPE, COMP_FUNCTOR, ARITY, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    static_assert(ARITY >= 2, "DaryPQ needs at least two children per node");
+
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<DaryPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+public:
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit DaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // DaryPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    DaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data{ start, end } {
+        updatePriorities();
+    } // DaryPQ
+
+
+    // Description: Destructor doesn't need any code, the data vector will
+    //              be destroyed automatically.
+    virtual ~DaryPQ() {
+    } // ~DaryPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        if (size() < 2)
+            return;
+        for (std::size_t i = parentOf(size() - 1) + 1; i-- > 0;) {
+            fixDown(i);
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n) / log(ARITY))
+    virtual void push(const TYPE &val) {
+        data.push_back(val);
+        fixUp(size() - 1);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: O(log(n) / log(ARITY))
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        fixUp(size() - 1);
+    } // push()
+
+
+    // Description: Construct a new element in place at the bottom of the heap.
+    // Runtime: O(log(n) / log(ARITY))
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        fixUp(size() - 1);
+    } // emplace()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    virtual void pop() {
+        if (size() > 1) {
+            data.front() = std::move(data.back());
+            this->stats().onMove();
+            data.pop_back();
+            fixDown(0);
+        }
+        else {
+            data.clear();
+        }
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the heap.
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    virtual TYPE pop_value() {
+        TYPE val = std::move(data.front());
+        pop();
+        return val;
+    } // pop_value()
+
+
+    // Description: Move every element of 'other' into this heap and leave
+    //              'other' empty, as BinaryPQ::merge() does.
+    // Runtime: O(min(m log(n + m) / log(ARITY), n + m)) for m elements in other.
+    void merge(DaryPQ &&other) {
+        if (&other == this)
+            return;
+        if (empty())
+            data.swap(other.data);
+        else
+            appendBatch(other.data.begin(), other.data.end());
+        other.data.clear();
+    } // merge()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+protected:
+    // Description: Add a batch of elements, choosing between k sift-ups and
+    //              one bottom-up rebuild by whichever bound is lower.
+    // Runtime: O(min(k log(n + k) / log(ARITY), n + k)) for k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        appendBatch(batch.begin(), batch.end());
+    } // pushBatch()
+
+
+private:
+    // Line-aligned storage; see CacheLineAllocator for the layout.
+    std::vector<TYPE, CacheLineAllocator<TYPE>> data;
+
+    // Move [first, last) onto the end of the heap and restore the invariant
+    // by sift-ups or one rebuild, whichever bound is lower.
+    template<typename Iterator>
+    void appendBatch(Iterator first, Iterator last) {
+        const std::size_t oldSize = size();
+        data.insert(data.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+        const std::size_t total = size();
+
+        std::size_t levels = 0;
+        for (std::size_t n = total; n > 1; n /= ARITY)
+            ++levels;
+        if ((total - oldSize) * levels > 2 * total) {
+            updatePriorities();
+        }
+        else {
+            for (std::size_t i = oldSize; i < total; ++i)
+                fixUp(i);
+        }
+    } // appendBatch()
+
+    static std::size_t parentOf(std::size_t ind) { return (ind - 1) / ARITY; }
+    static std::size_t firstChildOf(std::size_t ind) { return ARITY * ind + 1; }
+
+    // Move the element at ind up until its parent is at least as extreme.
+    // The element is held aside and parents are moved down into the hole.
+    void fixUp(std::size_t ind) {
+        TYPE val = std::move(data[ind]);
+        std::size_t depth = 0;
+        while (ind > 0) {
+            std::size_t parent = parentOf(ind);
+            if (!this->countedCompare(data[parent], val))
+                break;
+            data[ind] = std::move(data[parent]);
+            this->stats().onMove();
+            ind = parent;
+            ++depth;
+        }
+        data[ind] = std::move(val);
+        this->stats().onSift(depth);
+    } // fixUp()
+
+    // Move the element at ind down until no child is more extreme.  Each
+    // level scans one contiguous sibling group for its most extreme member.
+    void fixDown(std::size_t ind) {
+        const std::size_t n = size();
+        TYPE val = std::move(data[ind]);
+        std::size_t depth = 0;
+        for (std::size_t first = firstChildOf(ind); first < n; first = firstChildOf(ind)) {
+            std::size_t last = std::min(first + ARITY, n);
+            std::size_t extr = first;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                if (this->countedCompare(data[extr], data[i]))
+                    extr = i;
+            }
+            if (!this->countedCompare(val, data[extr]))
+                break;
+            data[ind] = std::move(data[extr]);
+            this->stats().onMove();
+            ind = extr;
+            ++depth;
+        }
+        data[ind] = std::move(val);
+        this->stats().onSift(depth);
+    } // fixDown()
+}; // DaryPQ
+
+
+#endif // DARYPQ_H
@@ -0,0 +1,80 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef DIRTYSET_H
+#define DIRTYSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// The elements passed to markDirty() by the array-based engines (BinaryPQ,
+// SortedPQ), which find them again with one pass over their array.
+//
+// Elements are matched by identity: std::hash<TYPE> and std::less<TYPE>,
+// which for pointers and indices (the usual element types whose priority
+// changes behind the queue's back) compare the element itself, never the
+// priority.  prepare() sorts the set and fills a bit filter with about 64
+// bits per element, so contains() rejects most clean elements with one bit
+// test and binary searches only the rest.
+template<typename TYPE>
+class DirtySet {
+public:
+    void add(const TYPE &val) {
+        vals.push_back(val);
+    } // add()
+
+    std::size_t size() const {
+        return vals.size();
+    } // size()
+
+    bool empty() const {
+        return vals.empty();
+    } // empty()
+
+    void clear() {
+        vals.clear();
+        filter.clear();
+    } // clear()
+
+    // Take in the dirty elements of 'other', leaving it empty.
+    void merge(DirtySet &other) {
+        vals.insert(vals.end(), other.vals.begin(), other.vals.end());
+        other.clear();
+    } // merge()
+
+    // Get ready for contains(); call after the last add().
+    void prepare() {
+        std::sort(vals.begin(), vals.end(), std::less<TYPE>());
+        shift = 64 - 6;
+        while ((std::size_t(1) << (64 - shift)) < 64 * vals.size())
+            --shift;
+        filter.assign((std::size_t(1) << (64 - shift)) / 64, 0);
+        for (const TYPE &val : vals) {
+            const std::size_t bit = bitOf(val);
+            filter[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        }
+    } // prepare()
+
+    bool contains(const TYPE &val) const {
+        const std::size_t bit = bitOf(val);
+        if ((filter[bit / 64] & (std::uint64_t(1) << (bit % 64))) == 0)
+            return false;
+        return std::binary_search(vals.begin(), vals.end(), val, std::less<TYPE>());
+    } // contains()
+
+private:
+    std::vector<TYPE> vals;
+    std::vector<std::uint64_t> filter;
+    unsigned shift = 0;
+
+    // Fibonacci hashing: the top bits of the product mix every bit of the
+    // hash, including the alignment zeros of a pointer.
+    std::size_t bitOf(const TYPE &val) const {
+        const std::uint64_t h = std::uint64_t(std::hash<TYPE>()(val));
+        return std::size_t((h * 0x9E3779B97F4A7C15ULL) >> shift);
+    } // bitOf()
+}; // DirtySet
+
+#endif // DIRTYSET_H
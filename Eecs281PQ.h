@@ -3,20 +3,50 @@
 #ifndef EECS281_PQ_H
 #define EECS281_PQ_H
 
+#include <algorithm>
 #include <functional>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 // A simple interface that implements a generic priority queue.
 // Runtime specifications assume constant time comparison and copying.
+// This is the type-erased, virtual interface; each engine also provides the
+// statically dispatched interface described in Eecs281StaticPQ.h.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
 class Eecs281PQ {
 public:
+    using value_type = TYPE;
+    using value_compare = COMP_FUNCTOR;
+
     virtual ~Eecs281PQ() {}
 
     // Description: Add a new element to the priority queue.
     virtual void push(const TYPE &val) = 0;
 
+    // Description: Add a new element to the priority queue, moving it in
+    //              instead of copying it.
+    virtual void push(TYPE &&val) = 0;
+
+    // Description: Construct a new element from 'args' and add it to the
+    //              priority queue.  Engines that can build the element in
+    //              place hide this with their own emplace(); this fallback
+    //              costs one move.
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        push(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+    // Description: Add every element of [first, last) to the priority queue.
+    //              The range is gathered into one batch, so that each engine
+    //              can use its bulk path (see pushBatch()) instead of
+    //              repeated push() calls.
+    template<typename InputIterator>
+    void push_range(InputIterator first, InputIterator last) {
+        std::vector<TYPE> batch(first, last);
+        pushBatch(batch);
+    } // push_range()
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the priority queue.
     // Note: We will not run tests on your code that would require it to pop an
@@ -24,6 +54,29 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     virtual void pop() = 0;
 
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the priority queue and return it, moved out rather than
+    //              copied.  Same precondition as pop().
+    virtual TYPE pop_value() = 0;
+
+    // Description: Remove the min(k, size()) most extreme elements and write
+    //              them to 'out', most extreme first.  Returns the iterator
+    //              past the last element written.  Engines extract the whole
+    //              batch at once (see popBatch()) instead of k pop() calls.
+    template<typename OutputIterator>
+    OutputIterator pop_n(std::size_t k, OutputIterator out) {
+        std::vector<TYPE> batch;
+        popBatch(std::min(k, size()), batch);
+        return std::move(batch.begin(), batch.end(), out);
+    } // pop_n()
+
+    // Description: Remove every element and write them to 'out', most
+    //              extreme first.
+    template<typename OutputIterator>
+    OutputIterator drain(OutputIterator out) {
+        return pop_n(size(), out);
+    } // drain()
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the priority queue.
     virtual const TYPE &top() const = 0;
@@ -43,6 +96,23 @@ protected:
     Eecs281PQ() {}
     explicit Eecs281PQ(const COMP_FUNCTOR &comp) : compare{ comp } {}
 
+    // Description: Add every element of 'batch' to the priority queue; the
+    //              elements may be moved out of 'batch'.  This default pushes
+    //              them one at a time; engines override it with a bulk path.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        for (TYPE &val : batch)
+            push(std::move(val));
+    } // pushBatch()
+
+    // Description: Append the k most extreme elements to 'batch', most extreme
+    //              first, and remove them.  k never exceeds size().  This
+    //              default pops them one at a time.
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        batch.reserve(batch.size() + k);
+        for (std::size_t i = 0; i < k; ++i)
+            batch.push_back(pop_value());
+    } // popBatch()
+
     // Note: These data members *must* be used in all of your priority queue
     //       implementations.
 
@@ -0,0 +1,132 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef EECS281_STATIC_PQ_H
+#define EECS281_STATIC_PQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+#include "PQStats.h"
+
+// The static (compile-time dispatched) side of the priority queue interface.
+//
+// Every engine derives from Eecs281StaticPQ<Engine, TYPE, COMP_FUNCTOR> and is
+// declared final.  Holding the concrete engine type therefore binds every
+// call statically: push(), pop(), top() and friends can be inlined together
+// with the comparator and the sift loops, and the helpers below reach the
+// engine's own batch paths directly.  Eecs281PQ stays the thin type-erased
+// interface for code that picks an engine at run time through a pointer.
+//
+// Generic code that wants the static path should take the engine as a
+// template parameter constrained with is_static_pq (see below).
+//
+// The STATS policy (see PQStats.h) is held as an empty private base when it
+// is NoStats.  Engines compare through countedCompare() and
+// countedComparator() instead of this->compare directly, so every comparison
+// reaches the policy's onCompare() hook.
+
+
+// Detects the static priority queue interface: a final class with the
+// push/pop/top/size/empty/updatePriorities/pop_value members of Eecs281PQ.
+template<typename PQ, typename = void>
+struct is_static_pq : std::false_type {};
+
+template<typename PQ>
+struct is_static_pq<PQ, std::void_t<
+    typename PQ::value_type,
+    decltype(std::declval<PQ &>().push(std::declval<const typename PQ::value_type &>())),
+    decltype(std::declval<PQ &>().push(std::declval<typename PQ::value_type &&>())),
+    decltype(std::declval<PQ &>().pop()),
+    decltype(std::declval<PQ &>().pop_value()),
+    decltype(std::declval<const PQ &>().top()),
+    decltype(std::declval<const PQ &>().size()),
+    decltype(std::declval<const PQ &>().empty()),
+    decltype(std::declval<PQ &>().updatePriorities())>>
+    : std::bool_constant<std::is_final<PQ>::value> {};
+
+
+template<typename DERIVED, typename TYPE, typename COMP_FUNCTOR, typename STATS = NoStats>
+class Eecs281StaticPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR>, private STATS {
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    using stats_type = STATS;
+
+    // Description: The statistics policy, for reading its counters.
+    // Runtime: O(1)
+    const STATS &stats() const {
+        return *this;
+    } // stats()
+
+
+    // Description: Same as Eecs281PQ::emplace(), bound to the engine's push().
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        derived().push(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Same as Eecs281PQ::push_range(), calling the engine's
+    //              pushBatch() directly.
+    template<typename InputIterator>
+    void push_range(InputIterator first, InputIterator last) {
+        std::vector<TYPE> batch(first, last);
+        derived().pushBatch(batch);
+    } // push_range()
+
+
+    // Description: Same as Eecs281PQ::pop_n(), calling the engine's
+    //              popBatch() directly.
+    template<typename OutputIterator>
+    OutputIterator pop_n(std::size_t k, OutputIterator out) {
+        std::vector<TYPE> batch;
+        derived().popBatch(std::min(k, derived().size()), batch);
+        return std::move(batch.begin(), batch.end(), out);
+    } // pop_n()
+
+
+    // Description: Same as Eecs281PQ::drain().
+    template<typename OutputIterator>
+    OutputIterator drain(OutputIterator out) {
+        return pop_n(derived().size(), out);
+    } // drain()
+
+protected:
+    using BaseClass::BaseClass;
+
+    // Description: this->compare(a, b), reported to the statistics policy.
+    bool countedCompare(const TYPE &a, const TYPE &b) const {
+        stats().onCompare();
+        return this->compare(a, b);
+    } // countedCompare()
+
+    // Description: A comparator for the standard algorithms that reports every
+    //              call; with statistics off it is just a copy of compare.
+    auto countedComparator() const {
+        if constexpr (STATS::enabled)
+            return [this](const TYPE &a, const TYPE &b) { return countedCompare(a, b); };
+        else
+            return this->compare;
+    } // countedComparator()
+
+    // The Eecs281PQ defaults, re-bound so that engines which keep them still
+    // call their own push() and pop_value() without a virtual dispatch.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        for (TYPE &val : batch)
+            derived().push(std::move(val));
+    } // pushBatch()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        batch.reserve(batch.size() + k);
+        for (std::size_t i = 0; i < k; ++i)
+            batch.push_back(derived().pop_value());
+    } // popBatch()
+
+private:
+    DERIVED &derived() { return static_cast<DERIVED &>(*this); }
+}; // Eecs281StaticPQ
+
+#endif // EECS281_STATIC_PQ_H
@@ -0,0 +1,411 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef EXTERNALPQ_H
+#define EXTERNALPQ_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "BinaryPQ.h"
+#include "Eecs281StaticPQ.h"
+
+// The memory an ExternalPQ may use, and where it puts its temporary files.
+struct ExternalBudget {
+    std::size_t memoryBytes = std::size_t(64) << 20;
+    std::string directory = "/tmp";
+};
+
+
+// An external-memory priority queue, for more elements than fit in RAM.
+// TYPE must be trivially copyable, since elements are written to disk as
+// raw bytes, and default constructible.
+//
+// Pushes go into an in-memory BinaryPQ, the insertion buffer, of about
+// half of budget.memoryBytes.  When it is full it is spilled: popped in
+// order, a block at a time, into a new run, a temporary file holding its
+// elements most extreme first.  Each run keeps one block of its elements in
+// memory (the first block never goes to disk), and the runs form a heap
+// ordered by the head of their blocks, so top() is the more extreme of the
+// buffer's top and the first run's head.  A run is written once and read
+// once, front to back: all I/O is sequential, in whole blocks.
+//
+// The budget bounds the memory that holds elements: the buffer is reserved
+// once, and the other half of the budget holds the run blocks and one
+// staging block that spills and merges write through, which caps the number
+// of runs.  A spill that would pass the cap first merges some runs into one
+// (again sequentially).  A run's level is floor(log2) of its length in
+// buffers when it is written, so a spilled run is level 0.  A merge takes up
+// to maxRuns / 2 runs of the lowest level that holds two or more.  While no
+// elements are popped from them, runs of level k hold at least 2^k buffers
+// each, so merging two or more writes a run of level k + 1 or more, and an
+// element is rewritten at most log2(n / B) times for a buffer of B elements
+// (nearer log base maxRuns / 2 in practice), not once per merge.  If every
+// level holds one run, the two lowest are merged instead; that takes
+// maxRuns runs at distinct levels, at least 2^(maxRuns - 1) buffers, so it
+// only happens with tiny budgets.  Temporary files are unlinked as soon as
+// they are created, so they disappear with the queue or the process.
+//
+// I/O errors throw std::system_error.  A run file is created before
+// anything is taken out of the buffer or the runs, so a bad directory loses
+// nothing; a write or read that fails part way through a spill or merge
+// loses the elements it was carrying.
+// STATS is a statistics policy from PQStats.h; it counts the comparisons
+// between runs and the buffer, not those inside the buffer.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename STATS = NoStats>
+class ExternalPQ final
+    : public Eecs281StaticPQ<ExternalPQ<TYPE, COMP_FUNCTOR, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    static_assert(std::is_trivially_copyable<TYPE>::value, "ExternalPQ writes elements as raw bytes");
+    static_assert(std::is_default_constructible<TYPE>::value, "ExternalPQ reads into default elements");
+
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<ExternalPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+public:
+    // Description: Construct an empty queue with a memory budget and an
+    //              optional comparison functor.
+    // Runtime: O(1)
+    explicit ExternalPQ(ExternalBudget budget = ExternalBudget(), COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, buffer{ comp }, directory{ std::move(budget.directory) } {
+        const std::size_t half = budget.memoryBytes / 2;
+        bufferCapacity = std::max<std::size_t>(1, half / sizeof(TYPE));
+        blockSize = std::clamp<std::size_t>(half / MIN_RUNS / sizeof(TYPE), 1,
+                                            std::max<std::size_t>(1, BLOCK_BYTES / sizeof(TYPE)));
+        // One block of the second half is the staging block.
+        maxRuns = std::max<std::size_t>(3, half / (blockSize * sizeof(TYPE))) - 1;
+        buffer.reserve(bufferCapacity);
+        staging.reserve(blockSize);
+    } // ExternalPQ()
+
+
+    // Description: Construct a queue out of an iterator range.
+    // Runtime: O(n log(n)), plus writing and reading each element about once
+    //          for every time it is spilled.
+    template<typename InputIterator>
+    ExternalPQ(InputIterator start, InputIterator end, ExternalBudget budget = ExternalBudget(),
+               COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        ExternalPQ{ std::move(budget), comp } {
+        for (InputIterator iter = start; iter != end; ++iter)
+            push(*iter);
+    } // ExternalPQ()
+
+
+    // The runs own open files.
+    ExternalPQ(const ExternalPQ &) = delete;
+    ExternalPQ &operator=(const ExternalPQ &) = delete;
+
+
+    // Description: Destructor doesn't need any code, the run files are closed
+    //              (and were already unlinked) automatically.
+    virtual ~ExternalPQ() {
+    } // ~ExternalPQ()
+
+
+    // Description: Assumes that all elements inside the queue are out of
+    //              order and 'rebuilds' it: every run is read back and pushed
+    //              again, so this costs a full external sort.  The old runs'
+    //              blocks go back to their files first, so the new runs never
+    //              share the budget with them.
+    // Runtime: O(n log(n)), plus reading and writing every spilled element.
+    virtual void updatePriorities() {
+        buffer.updatePriorities();
+        std::vector<Run> old;
+        old.swap(runs);
+        inRuns = 0;
+        for (Run &run : old) {
+            // Order no longer matters, so the unread block goes at the end.
+            const long readAt = std::ftell(run.file.get());
+            if (readAt < 0 || std::fseek(run.file.get(), 0, SEEK_END) != 0)
+                fail("cannot append to a run");
+            run.block.erase(run.block.begin(), run.block.begin() + std::ptrdiff_t(run.next));
+            write(run, run.block);
+            if (std::fflush(run.file.get()) != 0 || std::fseek(run.file.get(), readAt, SEEK_SET) != 0)
+                fail("cannot rewind a run");
+            std::vector<TYPE>().swap(run.block);
+        }
+        // Read through the staging block, never past a full buffer, so a
+        // spill only reuses it once the block has been pushed.
+        for (Run &run : old) {
+            while (run.unread != 0) {
+                const std::size_t count = std::size_t(std::min<std::uint64_t>(
+                    run.unread, std::min(blockSize, bufferCapacity - buffer.size())));
+                staging.resize(count);
+                if (std::fread(staging.data(), sizeof(TYPE), count, run.file.get()) != count)
+                    fail("cannot read a run");
+                run.unread -= count;
+                for (const TYPE &val : staging)
+                    buffer.push(val);
+                if (buffer.size() >= bufferCapacity)
+                    spill();
+            }
+            run.file.reset();
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element, spilling the insertion buffer to a new
+    //              run when it is full.
+    // Runtime: O(log(n)) amortized, plus one write per element spilled.
+    virtual void push(const TYPE &val) {
+        buffer.push(val);
+        if (buffer.size() >= bufferCapacity)
+            spill();
+    } // push()
+
+
+    // Description: Same as above, moving 'val' in.
+    // Runtime: O(log(n)) amortized, plus one write per element spilled.
+    virtual void push(TYPE &&val) {
+        push(static_cast<const TYPE &>(val));
+    } // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element.
+    // Runtime: O(log(n)), plus one read per block of a run.
+    virtual void pop() {
+        pop_value();
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it.
+    // Runtime: O(log(n)), plus one read per block of a run.
+    virtual TYPE pop_value() {
+        if (runs.empty() || (!buffer.empty() && !this->countedCompare(buffer.top(), runs.front().head())))
+            return buffer.pop_value();
+        return popRun();
+    } // pop_value()
+
+
+    // Description: Return the most extreme (defined by 'compare') element.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        if (runs.empty() || (!buffer.empty() && !this->countedCompare(buffer.top(), runs.front().head())))
+            return buffer.top();
+        return runs.front().head();
+    } // top()
+
+
+    // Description: Get the number of elements in the queue.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return buffer.size() + inRuns;
+    } // size()
+
+
+    // Description: Return true if the queue is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return size() == 0;
+    } // empty()
+
+
+    // Description: The number of runs, spilled and not yet popped empty.
+    // Runtime: O(1)
+    std::size_t numRuns() const {
+        return runs.size();
+    } // numRuns()
+
+
+    // Description: The number of bytes written to run files so far, by
+    //              spills and merges.
+    // Runtime: O(1)
+    std::uint64_t bytesWritten() const {
+        return written;
+    } // bytesWritten()
+
+
+private:
+    // Bytes per run block, at most; small budgets use smaller blocks.
+    static constexpr std::size_t BLOCK_BYTES = 64 << 10;
+    // Small budgets shrink the blocks to keep at least this many runs.
+    static constexpr std::size_t MIN_RUNS = 16;
+
+    struct CloseFile {
+        void operator()(std::FILE *file) const {
+            std::fclose(file);
+        }
+    };
+
+    // A sorted run: a temporary file read front to back, and the block of
+    // its elements read but not yet popped, block[next ..].  The run is
+    // exhausted when that block is empty.
+    struct Run {
+        std::unique_ptr<std::FILE, CloseFile> file;
+        std::uint64_t unread = 0;
+        std::vector<TYPE> block;
+        std::size_t next = 0;
+        // floor(log2) of the run's length in buffers when it was written.
+        std::size_t level = 0;
+
+        const TYPE &head() const {
+            return block[next];
+        }
+    };
+
+    BinaryPQ<TYPE, COMP_FUNCTOR> buffer;
+    // A max-heap by head under 'compare': runs.front() has the most extreme head.
+    std::vector<Run> runs;
+    // Elements in runs, in their blocks or on disk.
+    std::size_t inRuns = 0;
+    std::string directory;
+    std::size_t bufferCapacity = 1;
+    std::size_t blockSize = 1;
+    std::size_t maxRuns = 2;
+    // The block that spill() and mergeRuns() fill and write out.
+    std::vector<TYPE> staging;
+    std::uint64_t written = 0;
+
+    auto runOrder() const {
+        return [this](const Run &a, const Run &b) {
+            return this->countedCompare(a.head(), b.head());
+        };
+    } // runOrder()
+
+    [[noreturn]] static void fail(const char *what) {
+        throw std::system_error(errno, std::generic_category(), std::string("ExternalPQ: ") + what);
+    } // fail()
+
+    // A new empty temporary file in 'directory', already unlinked.
+    std::unique_ptr<std::FILE, CloseFile> createFile() const {
+        std::string path = directory + "/ExternalPQ.XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0)
+            fail("cannot create a run file");
+        unlink(path.c_str());
+        std::FILE *file = fdopen(fd, "w+b");
+        if (file == nullptr) {
+            int err = errno;
+            close(fd);
+            errno = err;
+            fail("cannot open a run file");
+        }
+        return std::unique_ptr<std::FILE, CloseFile>(file);
+    } // createFile()
+
+    void write(Run &run, const std::vector<TYPE> &block) {
+        if (!block.empty() && std::fwrite(block.data(), sizeof(TYPE), block.size(), run.file.get()) != block.size())
+            fail("cannot write a run");
+        run.unread += block.size();
+        written += block.size() * sizeof(TYPE);
+    } // write()
+
+    // Finish writing 'run' and get it ready for reading from the start.
+    void rewind(Run &run) {
+        if (std::fflush(run.file.get()) != 0 || std::fseek(run.file.get(), 0, SEEK_SET) != 0)
+            fail("cannot rewind a run");
+    } // rewind()
+
+    // Replace the run's block with its next block from disk, or empty it.
+    void refill(Run &run) {
+        const std::size_t count = std::size_t(std::min<std::uint64_t>(run.unread, blockSize));
+        run.block.resize(count);
+        run.next = 0;
+        if (count != 0 && std::fread(run.block.data(), sizeof(TYPE), count, run.file.get()) != count)
+            fail("cannot read a run");
+        run.unread -= count;
+    } // refill()
+
+    // Pop the head of the first run of 'heap', refilling or dropping that run.
+    TYPE popHead(std::vector<Run> &heap) {
+        std::pop_heap(heap.begin(), heap.end(), runOrder());
+        Run &run = heap.back();
+        TYPE val = run.block[run.next++];
+        if (run.next == run.block.size())
+            refill(run);
+        if (run.block.empty())
+            heap.pop_back();
+        else
+            std::push_heap(heap.begin(), heap.end(), runOrder());
+        return val;
+    } // popHead()
+
+    // Pop the head of the first run.
+    TYPE popRun() {
+        --inRuns;
+        return popHead(runs);
+    } // popRun()
+
+    // Drain the buffer into a new run.  Its first block stays in memory as
+    // the run's block; the rest goes to disk.
+    void spill() {
+        if (runs.size() + 1 > maxRuns)
+            mergeRuns();
+        Run run;
+        run.file = createFile();
+        const std::size_t count = buffer.size();
+        // Element by element: pop_n() would allocate index scratch of its own.
+        run.block.reserve(blockSize);
+        while (!buffer.empty() && run.block.size() < blockSize)
+            run.block.push_back(buffer.pop_value());
+        while (!buffer.empty()) {
+            staging.clear();
+            while (!buffer.empty() && staging.size() < blockSize)
+                staging.push_back(buffer.pop_value());
+            write(run, staging);
+        }
+        rewind(run);
+        inRuns += count;
+        runs.push_back(std::move(run));
+        std::push_heap(runs.begin(), runs.end(), runOrder());
+    } // spill()
+
+    // Merge up to maxRuns / 2 runs of the lowest level holding two or more
+    // into one; if every level holds one run, merge the two lowest.  There
+    // are at least two runs.
+    void mergeRuns() {
+        Run merged;
+        merged.file = createFile();
+        std::sort(runs.begin(), runs.end(),
+                  [](const Run &a, const Run &b) { return a.level < b.level; });
+        std::size_t first = 0;
+        while (first + 1 < runs.size() && runs[first].level != runs[first + 1].level)
+            ++first;
+        std::size_t last = first + 2;
+        if (last > runs.size()) {
+            first = 0;
+            last = 2;
+        }
+        else {
+            const std::size_t fanIn = std::max<std::size_t>(2, maxRuns / 2);
+            while (last < runs.size() && last - first < fanIn && runs[last].level == runs[first].level)
+                ++last;
+        }
+        std::vector<Run> group(std::make_move_iterator(runs.begin() + std::ptrdiff_t(first)),
+                               std::make_move_iterator(runs.begin() + std::ptrdiff_t(last)));
+        runs.erase(runs.begin() + std::ptrdiff_t(first), runs.begin() + std::ptrdiff_t(last));
+        std::make_heap(runs.begin(), runs.end(), runOrder());
+        std::make_heap(group.begin(), group.end(), runOrder());
+
+        staging.clear();
+        while (!group.empty()) {
+            staging.push_back(popHead(group));
+            if (staging.size() == blockSize) {
+                write(merged, staging);
+                staging.clear();
+            }
+        }
+        write(merged, staging);
+        for (std::uint64_t buffers = merged.unread / bufferCapacity; buffers > 1; buffers /= 2)
+            ++merged.level;
+        rewind(merged);
+        refill(merged);
+        if (!merged.block.empty()) {
+            runs.push_back(std::move(merged));
+            std::push_heap(runs.begin(), runs.end(), runOrder());
+        }
+    } // mergeRuns()
+}; // ExternalPQ
+
+#endif // EXTERNALPQ_H
@@ -0,0 +1,62 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef KEYOF_H
+#define KEYOF_H
+
+#include <functional>
+
+// Key extractors for the engines that order elements by an integral key
+// instead of a comparison functor (RadixPQ, BucketPQ).  A key extractor is a
+// function object taking const TYPE & and returning an integer.  KeyedPQ
+// takes any key type, through ByKey below.
+
+
+// The default key extractor: the element is its own key.
+struct IdentityKey {
+    template<typename T>
+    const T &operator()(const T &val) const {
+        return val;
+    }
+};
+
+
+// A comparison functor that orders elements by their keys: keyOf maps an
+// element to its key and keyComp orders the keys.  Any engine can use it as
+// an ordinary comparison functor; KeyedPQ looks inside it (see KeyOrder) to
+// store and compare the keys alone.
+template<typename KEY_OF = IdentityKey, typename KEY_COMP = std::less<>>
+struct ByKey {
+    KEY_OF keyOf;
+    KEY_COMP keyComp;
+
+    template<typename T>
+    bool operator()(const T &a, const T &b) const {
+        return keyComp(keyOf(a), keyOf(b));
+    }
+};
+
+
+// The key extractor and key order of a comparison functor.  A ByKey has
+// its own; any other functor orders whole elements, which are then their
+// own keys.
+template<typename COMP_FUNCTOR>
+struct KeyOrder {
+    static IdentityKey keyOf(const COMP_FUNCTOR &) {
+        return IdentityKey();
+    }
+    static const COMP_FUNCTOR &keyComp(const COMP_FUNCTOR &comp) {
+        return comp;
+    }
+};
+
+template<typename KEY_OF, typename KEY_COMP>
+struct KeyOrder<ByKey<KEY_OF, KEY_COMP>> {
+    static const KEY_OF &keyOf(const ByKey<KEY_OF, KEY_COMP> &comp) {
+        return comp.keyOf;
+    }
+    static const KEY_COMP &keyComp(const ByKey<KEY_OF, KEY_COMP> &comp) {
+        return comp.keyComp;
+    }
+};
+
+#endif // KEYOF_H
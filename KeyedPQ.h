@@ -0,0 +1,309 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef KEYEDPQ_H
+#define KEYEDPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Eecs281StaticPQ.h"
+#include "CacheLineAllocator.h"
+#include "KeyOf.h"
+
+// A d-ary heap for large elements ordered by a small key, such as jobs
+// ordered by a 64-bit deadline.  COMP_FUNCTOR is normally a ByKey (see
+// KeyOf.h), which names the key and its order; any other comparison functor
+// makes each element its own key.  The heap stores each element's key in a
+// dense array, and the element itself in a stable payload slot that never
+// moves while it is in the heap.
+//
+// The heap is kept as two parallel arrays, keys[] and slots[], where
+// slots[i] is the payload slot of the element whose key is keys[i].
+// fixUp() and fixDown() compare and move only keys and slot numbers, so a
+// sift step moves sizeof(key_type) + sizeof(size_t) bytes whatever the size
+// of TYPE, and each sibling group of keys lies inside one cache line when
+// 64 % (ARITY*sizeof(key_type)) == 0 (see CacheLineAllocator).  An element is
+// moved into its slot by push() and out of it by pop_value(), and touched
+// by nothing in between but top() and updatePriorities().
+//
+// Slots freed by pops are reused by later pushes; the payload array is
+// released when the heap runs empty.
+// STATS is a statistics policy from PQStats.h; it counts key comparisons.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t ARITY = 2,
+         typename STATS = NoStats>
+class KeyedPQ final
+    : public Eecs281StaticPQ<KeyedPQ<TYPE, COMP_FUNCTOR, ARITY, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    static_assert(ARITY >= 2, "KeyedPQ needs at least two children per node");
+
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<KeyedPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+    using Order = KeyOrder<COMP_FUNCTOR>;
+
+public:
+    using key_type = std::decay_t<decltype(
+        Order::keyOf(std::declval<const COMP_FUNCTOR &>())(std::declval<const TYPE &>()))>;
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit KeyedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // KeyedPQ()
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    KeyedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+        for (InputIterator iter = start; iter != end; ++iter)
+            append(*iter);
+        updatePriorities();
+    } // KeyedPQ()
+
+
+    // Description: Destructor doesn't need any code, the vectors will be
+    //              destroyed automatically.
+    virtual ~KeyedPQ() {
+    } // ~KeyedPQ()
+
+
+    // Description: Assumes that the keys of the elements inside the heap have
+    //              changed, reads them again and 'rebuilds' the heap.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        for (std::size_t i = 0; i < size(); ++i)
+            keys[i] = Order::keyOf(this->compare)(payload[slots[i]]);
+        heapify();
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n) / log(ARITY))
+    virtual void push(const TYPE &val) {
+        append(val);
+        fixUp(size() - 1);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: O(log(n) / log(ARITY))
+    virtual void push(TYPE &&val) {
+        append(std::move(val));
+        fixUp(size() - 1);
+    } // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    virtual void pop() {
+        pop_value();
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of its slot.
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    virtual TYPE pop_value() {
+        TYPE val = std::move(payload[slots.front()]);
+        freeSlots.push_back(slots.front());
+        if (size() > 1) {
+            keys.front() = std::move(keys.back());
+            slots.front() = slots.back();
+            this->stats().onMove();
+            keys.pop_back();
+            slots.pop_back();
+            fixDown(0);
+        }
+        else {
+            keys.clear();
+            slots.clear();
+            payload.clear();
+            freeSlots.clear();
+        }
+        return val;
+    } // pop_value()
+
+
+    // Description: Move every element of 'other' into this heap and leave
+    //              'other' empty, as DaryPQ::merge() does.
+    // Runtime: O(min(m log(n + m) / log(ARITY), n + m)) for m elements in other.
+    void merge(KeyedPQ &&other) {
+        if (&other == this)
+            return;
+        if (empty()) {
+            keys.swap(other.keys);
+            slots.swap(other.slots);
+            payload.swap(other.payload);
+            freeSlots.swap(other.freeSlots);
+        }
+        else {
+            const std::size_t oldSize = size();
+            for (std::size_t slot : other.slots)
+                append(std::move(other.payload[slot]));
+            restore(oldSize);
+        }
+        other.keys.clear();
+        other.slots.clear();
+        other.payload.clear();
+        other.freeSlots.clear();
+    } // merge()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return payload[slots.front()];
+    } // top()
+
+
+    // Description: Return the key of the most extreme element, without
+    //              touching the element itself.
+    // Runtime: O(1)
+    const key_type &topKey() const {
+        return keys.front();
+    } // topKey()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return keys.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return keys.empty();
+    } // empty()
+
+
+protected:
+    // Description: Add a batch of elements, choosing between k sift-ups and
+    //              one bottom-up rebuild by whichever bound is lower.
+    // Runtime: O(min(k log(n + k) / log(ARITY), n + k)) for k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        const std::size_t oldSize = size();
+        for (TYPE &val : batch)
+            append(std::move(val));
+        restore(oldSize);
+    } // pushBatch()
+
+
+private:
+    // The heap order lives in keys[] and slots[]; the elements in payload[].
+    std::vector<key_type, CacheLineAllocator<key_type>> keys;
+    std::vector<std::size_t> slots;
+    std::vector<TYPE> payload;
+    // Payload slots whose elements were popped, for reuse.
+    std::vector<std::size_t> freeSlots;
+
+    // Store 'val' in a free slot and its key at the bottom of the heap,
+    // without restoring the heap invariant.
+    template<typename VALUE>
+    void append(VALUE &&val) {
+        std::size_t slot;
+        if (freeSlots.empty()) {
+            slot = payload.size();
+            payload.push_back(std::forward<VALUE>(val));
+        }
+        else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            payload[slot] = std::forward<VALUE>(val);
+        }
+        keys.push_back(Order::keyOf(this->compare)(payload[slot]));
+        slots.push_back(slot);
+    } // append()
+
+    // Restore the invariant after appends past 'oldSize', by sift-ups or one
+    // rebuild, whichever bound is lower.
+    void restore(std::size_t oldSize) {
+        const std::size_t total = size();
+        std::size_t levels = 0;
+        for (std::size_t n = total; n > 1; n /= ARITY)
+            ++levels;
+        if ((total - oldSize) * levels > 2 * total) {
+            heapify();
+        }
+        else {
+            for (std::size_t i = oldSize; i < total; ++i)
+                fixUp(i);
+        }
+    } // restore()
+
+    void heapify() {
+        if (size() < 2)
+            return;
+        for (std::size_t i = parentOf(size() - 1) + 1; i-- > 0;) {
+            fixDown(i);
+        }
+    } // heapify()
+
+    static std::size_t parentOf(std::size_t ind) { return (ind - 1) / ARITY; }
+    static std::size_t firstChildOf(std::size_t ind) { return ARITY * ind + 1; }
+
+    // The key order, reported to the statistics policy.
+    bool countedKeyCompare(const key_type &a, const key_type &b) const {
+        this->stats().onCompare();
+        return Order::keyComp(this->compare)(a, b);
+    } // countedKeyCompare()
+
+    // Move the entry at ind up until its parent is at least as extreme.
+    void fixUp(std::size_t ind) {
+        key_type key = std::move(keys[ind]);
+        const std::size_t slot = slots[ind];
+        std::size_t depth = 0;
+        while (ind > 0) {
+            std::size_t parent = parentOf(ind);
+            if (!countedKeyCompare(keys[parent], key))
+                break;
+            keys[ind] = std::move(keys[parent]);
+            slots[ind] = slots[parent];
+            this->stats().onMove();
+            ind = parent;
+            ++depth;
+        }
+        keys[ind] = std::move(key);
+        slots[ind] = slot;
+        this->stats().onSift(depth);
+    } // fixUp()
+
+    // Move the entry at ind down until no child is more extreme.  Each level
+    // scans one contiguous group of sibling keys.
+    void fixDown(std::size_t ind) {
+        const std::size_t n = size();
+        key_type key = std::move(keys[ind]);
+        const std::size_t slot = slots[ind];
+        std::size_t depth = 0;
+        for (std::size_t first = firstChildOf(ind); first < n; first = firstChildOf(ind)) {
+            std::size_t last = std::min(first + ARITY, n);
+            std::size_t extr = first;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                if (countedKeyCompare(keys[extr], keys[i]))
+                    extr = i;
+            }
+            if (!countedKeyCompare(key, keys[extr]))
+                break;
+            keys[ind] = std::move(keys[extr]);
+            slots[ind] = slots[extr];
+            this->stats().onMove();
+            ind = extr;
+            ++depth;
+        }
+        keys[ind] = std::move(key);
+        slots[ind] = slot;
+        this->stats().onSift(depth);
+    } // fixDown()
+}; // KeyedPQ
+
+#endif // KEYEDPQ_H
@@ -0,0 +1,258 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef MPSCINGESTPQ_H
+#define MPSCINGESTPQ_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Eecs281StaticPQ.h"
+
+// A priority queue that many threads may push into while ONE thread, the
+// consumer, reads and pops.  Pushes go into a bounded lock-free ring buffer
+// (Vyukov's bounded queue, with one consumer) instead of the engine; the
+// consumer moves everything buffered into the engine PQ, as one push_range(),
+// at the start of top(), pop(), pop_value(), size(), empty() and
+// updatePriorities().  Producers therefore never wait for a sift and never
+// take a lock; they only contend with each other on one atomic counter.
+//
+// PQ is any engine (BinaryPQ, PairingPQ, ...).  CAPACITY, a power of two, is
+// the number of buffered elements.  When the buffer is full, try_push()
+// fails and push() yields until the consumer drains it, so a consumer that
+// stops calling top()/pop() eventually stalls the producers.
+//
+// Every member except push(), try_push() and emplace() is for the consumer
+// thread only.  The ordering is exact over what has been taken in: each
+// top() first drains the published prefix of the ring, up to the first slot
+// a producer has claimed but not yet filled.  A push that completed after
+// such a slot was claimed stays buffered until that producer finishes, so
+// top() may not see it yet.
+template<typename PQ, std::size_t CAPACITY = 1024>
+class MpscIngestPQ final
+    : public Eecs281StaticPQ<MpscIngestPQ<PQ, CAPACITY>,
+                             typename PQ::value_type, typename PQ::value_compare> {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "MpscIngestPQ needs a power-of-two CAPACITY");
+
+    using TYPE = typename PQ::value_type;
+    using COMP_FUNCTOR = typename PQ::value_compare;
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<MpscIngestPQ, TYPE, COMP_FUNCTOR>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+public:
+    // Description: Construct an empty queue with an optional comparison functor.
+    // Runtime: O(CAPACITY)
+    explicit MpscIngestPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, pq{ comp }, cells{ new Cell[CAPACITY] } {
+        for (std::size_t i = 0; i < CAPACITY; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    } // MpscIngestPQ()
+
+    MpscIngestPQ(const MpscIngestPQ &) = delete;
+    MpscIngestPQ &operator=(const MpscIngestPQ &) = delete;
+
+
+    // Description: Destroy anything still buffered along with the engine.
+    //              No producer may be pushing.
+    // Runtime: O(n + CAPACITY)
+    virtual ~MpscIngestPQ() {
+        TYPE *val;
+        while ((val = front()) != nullptr) {
+            val->~TYPE();
+            release();
+        }
+    } // ~MpscIngestPQ()
+
+
+    // Description: Buffer 'val' if there is room.  Safe from any thread.
+    // Runtime: O(1), lock-free apart from retries of a failed CAS.
+    bool try_push(const TYPE &val) {
+        return tryPushImpl(val);
+    } // try_push()
+
+
+    // Description: Same as above, moving 'val' in (only if it succeeds).
+    // Runtime: O(1)
+    bool try_push(TYPE &&val) {
+        return tryPushImpl(std::move(val));
+    } // try_push()
+
+
+    // Description: Buffer 'val', yielding while the buffer is full.  Safe
+    //              from any thread.
+    // Runtime: O(1) while the buffer has room.
+    virtual void push(const TYPE &val) {
+        while (!tryPushImpl(val))
+            std::this_thread::yield();
+    } // push()
+
+
+    // Description: Same as above, moving 'val' in.
+    // Runtime: O(1) while the buffer has room.
+    virtual void push(TYPE &&val) {
+        while (!tryPushImpl(std::move(val)))
+            std::this_thread::yield();
+    } // push()
+
+
+    // Description: Take in the buffer, then remove the most extreme element.
+    //              Consumer only.
+    // Runtime: that of PQ::push_range() for the buffered elements plus PQ::pop().
+    virtual void pop() {
+        drainBuffer();
+        pq.pop();
+    } // pop()
+
+
+    // Description: Take in the buffer, then remove and return the most
+    //              extreme element.  Consumer only.
+    // Runtime: as pop().
+    virtual TYPE pop_value() {
+        drainBuffer();
+        return pq.pop_value();
+    } // pop_value()
+
+
+    // Description: Take in the buffer, then return the most extreme element.
+    //              Consumer only.
+    // Runtime: that of PQ::push_range() for the buffered elements plus PQ::top().
+    virtual const TYPE &top() const {
+        drainBuffer();
+        return pq.top();
+    } // top()
+
+
+    // Description: The number of elements, counting everything pushed before
+    //              the call.  Consumer only.
+    // Runtime: as top().
+    virtual std::size_t size() const {
+        drainBuffer();
+        return pq.size();
+    } // size()
+
+
+    // Description: Return true if nothing has been pushed and not popped.
+    //              Consumer only.
+    // Runtime: as top().
+    virtual bool empty() const {
+        drainBuffer();
+        return pq.empty();
+    } // empty()
+
+
+    // Description: Take in the buffer, then let the engine rebuild.
+    //              Consumer only.
+    // Runtime: that of PQ::updatePriorities().
+    virtual void updatePriorities() {
+        drainBuffer();
+        pq.updatePriorities();
+    } // updatePriorities()
+
+
+protected:
+    // Description: push_range() from a producer buffers the elements one by
+    //              one, like push().
+    // Runtime: O(k) for a batch of k elements while the buffer has room.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        for (TYPE &val : batch)
+            push(std::move(val));
+    } // pushBatch()
+
+
+    // Description: Take in the buffer and let the engine's own pop_n() do
+    //              the batched extraction.  Consumer only.
+    // Runtime: that of PQ::pop_n().
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        drainBuffer();
+        pq.pop_n(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+private:
+    // One slot of the ring.  'sequence' says whose turn it is: equal to the
+    // enqueue position when a producer may fill it, one past it when the
+    // consumer may empty it.
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(TYPE) unsigned char bytes[sizeof(TYPE)];
+    };
+
+    // The engine and the consumer's state; top() is const but takes in the
+    // buffer, hence mutable.
+    mutable PQ pq;
+    mutable std::vector<TYPE> incoming;
+    std::unique_ptr<Cell[]> cells;
+    // Producers claim slots here; kept on its own cache line, away from the
+    // consumer's position.
+    alignas(64) std::atomic<std::size_t> enqueuePos{ 0 };
+    alignas(64) mutable std::size_t dequeuePos = 0;
+
+    template<typename VALUE>
+    bool tryPushImpl(VALUE &&val) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &cells[pos & (CAPACITY - 1)];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) {
+                // The slot still holds an element from one lap ago: full.
+                return false;
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        } // for
+        ::new (static_cast<void *>(cell->bytes)) TYPE(std::forward<VALUE>(val));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    } // tryPushImpl()
+
+    // The consumer's next element, or nullptr if it has not been published.
+    TYPE *front() const {
+        Cell &cell = cells[dequeuePos & (CAPACITY - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            return nullptr;
+        return std::launder(reinterpret_cast<TYPE *>(cell.bytes));
+    } // front()
+
+    // Hand the consumer's current slot back to the producers.
+    void release() const {
+        Cell &cell = cells[dequeuePos & (CAPACITY - 1)];
+        cell.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        ++dequeuePos;
+    } // release()
+
+    // Move the published elements into the engine with one push_range().
+    // At most one buffer's worth is taken, so busy producers cannot keep
+    // the consumer here forever.
+    void drainBuffer() const {
+        TYPE *val;
+        while (incoming.size() < CAPACITY && (val = front()) != nullptr) {
+            incoming.push_back(std::move(*val));
+            val->~TYPE();
+            release();
+        }
+        if (incoming.empty())
+            return;
+        if (incoming.size() == 1)
+            pq.push(std::move(incoming.front()));
+        else
+            pq.push_range(std::make_move_iterator(incoming.begin()),
+                          std::make_move_iterator(incoming.end()));
+        incoming.clear();
+    } // drainBuffer()
+}; // MpscIngestPQ
+
+#endif // MPSCINGESTPQ_H
@@ -0,0 +1,207 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef MULTIQUEUEPQ_H
+#define MULTIQUEUEPQ_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BinaryPQ.h"
+
+// A concurrent, relaxed priority queue: the MultiQueue of Rihani, Sanders and
+// Dementiev ("MultiQueues: Simple Relaxed Concurrent Priority Queues", SPAA
+// 2015).  The elements are spread over S shards, each a BinaryPQ behind its
+// own mutex.
+//   push()     locks one shard chosen at random and pushes into it.
+//   try_pop()  samples two shards at random, locks both, and pops from the
+//              one whose top is more extreme.
+// Threads rarely meet on the same shard, so there is no single lock for all
+// of them to queue on.
+//
+// The price is that try_pop() does not always return the most extreme
+// element.  Call the rank of a popped element the number of elements in the
+// whole queue that are more extreme than it (a strict queue always pops rank
+// 0).  With two choices and S shards, the analysis of Alistarh, Kopinsky, Li
+// and Nadiradze ("The Power of Choice in Priority Scheduling", PODC 2017)
+// bounds the expected rank of each pop by O(S), and the expected worst rank
+// over a run by O(S log S), independently of the queue size and of how long
+// the run is.  Sampling one shard instead of two loses the bound: ranks then
+// grow without limit.  Use S = 2 to 4 times the number of threads; fewer
+// shards lower the rank error but bring the contention back.
+//
+// This is not an Eecs281PQ: top() cannot hand out a reference to an element
+// another thread may pop, and under concurrency "is it empty, then pop" must
+// be one step.  try_pop() is that step.  size() and empty() are exact only
+// when no other thread is pushing or popping.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class MultiQueuePQ {
+public:
+    using value_type = TYPE;
+    using value_compare = COMP_FUNCTOR;
+
+    // Description: Construct an empty queue with 'shards' shards, or four per
+    //              hardware thread if 'shards' is 0.  One shard is a single
+    //              locked heap: try_pop() is then exact, and every thread
+    //              contends on its lock.
+    // Runtime: O(shards)
+    explicit MultiQueuePQ(std::size_t shards = 0, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        shardList(shards != 0 ? shards : defaultShardCount()), compare{ comp } {
+        for (Shard &shard : shardList)
+            shard.heap = BinaryPQ<TYPE, COMP_FUNCTOR>{ comp };
+    } // MultiQueuePQ()
+
+    MultiQueuePQ(const MultiQueuePQ &) = delete;
+    MultiQueuePQ &operator=(const MultiQueuePQ &) = delete;
+
+
+    // Description: Add a new element to a randomly chosen shard.
+    // Runtime: O(log(n / S)), plus the wait for that shard's lock.
+    void push(const TYPE &val) {
+        Shard &shard = shardList[randomShard()];
+        std::lock_guard<std::mutex> guard{ shard.lock };
+        shard.heap.push(val);
+        shard.count.store(shard.heap.size(), std::memory_order_relaxed);
+    } // push()
+
+
+    // Description: Add a new element to a randomly chosen shard, moving it in.
+    // Runtime: O(log(n / S)), plus the wait for that shard's lock.
+    void push(TYPE &&val) {
+        Shard &shard = shardList[randomShard()];
+        std::lock_guard<std::mutex> guard{ shard.lock };
+        shard.heap.push(std::move(val));
+        shard.count.store(shard.heap.size(), std::memory_order_relaxed);
+    } // push()
+
+
+    // Description: Move the more extreme top of two random shards into 'out'
+    //              and return true.  Busy shards are skipped rather than
+    //              waited for, and a skip does not use up a sample.  After
+    //              2 S samples that found both shards empty, the relaxed
+    //              counts are checked: if any shard holds elements, sampling
+    //              starts over; if none does, every shard is locked in turn,
+    //              from a random one, to confirm, so false means the queue
+    //              was seen empty (each shard at the moment it was checked).
+    //              With one shard, that sweep is the whole pop.
+    // Runtime: O(log(n / S)) expected while the queue is not nearly empty;
+    //          O(S log(n / S)) when the sweep is needed.
+    bool try_pop(TYPE &out) {
+        const std::size_t numShards = shardList.size();
+        // There are no two shards to sample from one; the sweep pops it.
+        while (numShards >= 2) {
+            for (std::size_t emptySamples = 0; emptySamples < 2 * numShards;) {
+                std::size_t first = randomShard();
+                std::size_t second = randomShard();
+                if (second == first)
+                    second = (first + 1) % numShards;
+                Shard &a = shardList[first];
+                Shard &b = shardList[second];
+                // Shards that look empty are not worth locking.
+                if (a.count.load(std::memory_order_relaxed) == 0
+                    && b.count.load(std::memory_order_relaxed) == 0) {
+                    ++emptySamples;
+                    continue;
+                }
+
+                // try_lock on both means two threads can never wait on each
+                // other, whatever order they sampled the shards in.
+                std::unique_lock<std::mutex> lockA{ a.lock, std::try_to_lock };
+                if (!lockA.owns_lock())
+                    continue;
+                std::unique_lock<std::mutex> lockB{ b.lock, std::try_to_lock };
+                if (!lockB.owns_lock())
+                    continue;
+
+                Shard *best = &a;
+                if (a.heap.empty() || (!b.heap.empty() && compare(a.heap.top(), b.heap.top())))
+                    best = &b;
+                if (best->heap.empty()) {
+                    ++emptySamples;
+                    continue;
+                }
+                out = best->heap.pop_value();
+                best->count.store(best->heap.size(), std::memory_order_relaxed);
+                return true;
+            } // for
+            if (size() == 0)
+                break;
+        } // while
+
+        const std::size_t start = numShards >= 2 ? randomShard() : 0;
+        for (std::size_t i = 0; i < numShards; ++i) {
+            Shard &shard = shardList[(start + i) % numShards];
+            std::lock_guard<std::mutex> guard{ shard.lock };
+            if (!shard.heap.empty()) {
+                out = shard.heap.pop_value();
+                shard.count.store(shard.heap.size(), std::memory_order_relaxed);
+                return true;
+            }
+        } // for
+        return false;
+    } // try_pop()
+
+
+    // Description: The number of elements, summed over the shards without
+    //              locking them.
+    // Runtime: O(S)
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (const Shard &shard : shardList)
+            total += shard.count.load(std::memory_order_relaxed);
+        return total;
+    } // size()
+
+
+    // Description: Return true if every shard is empty.
+    // Runtime: O(S)
+    bool empty() const {
+        return size() == 0;
+    } // empty()
+
+
+    // Description: The number of shards, S.
+    // Runtime: O(1)
+    std::size_t shardCount() const {
+        return shardList.size();
+    } // shardCount()
+
+
+private:
+    // Each shard sits on its own cache lines, so threads working on
+    // different shards do not invalidate each other's lock word.
+    struct alignas(64) Shard {
+        std::mutex lock;
+        BinaryPQ<TYPE, COMP_FUNCTOR> heap;
+        // heap.size(), published for the lock-free size() and for skipping
+        // empty shards without taking their locks.
+        std::atomic<std::size_t> count{ 0 };
+    };
+
+    std::vector<Shard> shardList;
+    COMP_FUNCTOR compare;
+
+    static std::size_t defaultShardCount() {
+        std::size_t threads = std::thread::hardware_concurrency();
+        return 4 * (threads == 0 ? 1 : threads);
+    } // defaultShardCount()
+
+    // A per-thread xorshift generator, seeded from the address of its own
+    // thread-local state so that threads do not walk the shards in step.
+    std::size_t randomShard() const {
+        thread_local std::uint64_t state = 0;
+        if (state == 0) {
+            state = (reinterpret_cast<std::uintptr_t>(&state) * 0x9E3779B97F4A7C15ULL) | 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return std::size_t(state % shardList.size());
+    } // randomShard()
+}; // MultiQueuePQ
+
+#endif // MULTIQUEUEPQ_H
@@ -0,0 +1,174 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Node allocators for node-based priority queues such as PairingPQ.
+//
+// A node allocator is a class template over the node type that provides:
+//   NODE *create(Args &&...)  construct a node in fresh or recycled storage
+//   void destroy(NODE *)      destroy a node and recycle its storage
+//   void release()            drop every node at once, without destructors
+//   void adopt(ALLOC &&)      take over another allocator's nodes
+//   bulk_release              true if release() actually frees the storage,
+//                             so the owner may skip the per-node teardown
+
+
+// The default allocator.  Nodes are carved out of slabs of about 16KiB, and
+// destroyed nodes are kept on an intrusive free list, so steady-state
+// push/pop churn never reaches malloc.  Freeing the whole arena is one
+// delete[] per slab.
+template<typename NODE>
+class NodeArena {
+public:
+    static constexpr bool bulk_release = true;
+
+    NodeArena() {}
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    NodeArena(NodeArena &&other) noexcept :
+        slabs{ std::move(other.slabs) }, freeList{ other.freeList }, used{ other.used } {
+        other.slabs.clear();
+        other.freeList = nullptr;
+        other.used = NODES_PER_SLAB;
+    } // NodeArena()
+
+    NodeArena &operator=(NodeArena &&other) noexcept {
+        NodeArena temp(std::move(other));
+        swap(temp);
+        return *this;
+    } // operator=()
+
+    ~NodeArena() {
+        release();
+    } // ~NodeArena()
+
+
+    // Description: Construct a NODE from 'args' in a recycled slot if there
+    //              is one, otherwise in the next slot of the current slab.
+    // Runtime: O(1), plus one allocation every NODES_PER_SLAB nodes.
+    template<typename... Args>
+    NODE *create(Args &&... args) {
+        Slot *slot = freeList;
+        if (slot != nullptr) {
+            freeList = slot->next;
+        }
+        else {
+            if (used == NODES_PER_SLAB) {
+                slabs.push_back(new Slot[NODES_PER_SLAB]);
+                used = 0;
+            }
+            slot = slabs.back() + used++;
+        }
+        return ::new (static_cast<void *>(slot->bytes)) NODE(std::forward<Args>(args)...);
+    } // create()
+
+
+    // Description: Destroy a NODE and put its slot on the free list.
+    // Runtime: O(1)
+    void destroy(NODE *node) {
+        node->~NODE();
+        Slot *slot = reinterpret_cast<Slot *>(node);
+        slot->next = freeList;
+        freeList = slot;
+    } // destroy()
+
+
+    // Description: Free every slab.  Destructors of live nodes are NOT run;
+    //              the owner must have run them already if they matter.
+    // Runtime: O(number of slabs)
+    void release() {
+        for (Slot *slab : slabs)
+            delete[] slab;
+        slabs.clear();
+        freeList = nullptr;
+        used = NODES_PER_SLAB;
+    } // release()
+
+
+    // Description: Take ownership of all of other's storage, so that nodes
+    //              created by 'other' may later be destroyed through this arena.
+    // Runtime: O(number of slabs in other + length of other's free list)
+    void adopt(NodeArena &&other) {
+        if (other.slabs.empty())
+            return;
+        if (slabs.empty()) {
+            swap(other);
+            return;
+        }
+        // Keep our partially used slab last so bump allocation continues in
+        // it; the unused tail of other's last slab is simply never handed out.
+        Slot *current = slabs.back();
+        slabs.back() = other.slabs.front();
+        slabs.insert(slabs.end(), other.slabs.begin() + 1, other.slabs.end());
+        slabs.push_back(current);
+        if (other.freeList != nullptr) {
+            Slot *last = other.freeList;
+            while (last->next != nullptr)
+                last = last->next;
+            last->next = freeList;
+            freeList = other.freeList;
+        }
+        other.slabs.clear();
+        other.freeList = nullptr;
+        other.used = NODES_PER_SLAB;
+    } // adopt()
+
+
+    void swap(NodeArena &other) noexcept {
+        std::swap(slabs, other.slabs);
+        std::swap(freeList, other.freeList);
+        std::swap(used, other.used);
+    } // swap()
+
+private:
+    // Storage for one NODE, or a link in the free list once it is recycled.
+    union Slot {
+        Slot *next;
+        alignas(NODE) unsigned char bytes[sizeof(NODE)];
+    };
+
+    static constexpr std::size_t NODES_PER_SLAB =
+        std::max<std::size_t>(16, 16384 / sizeof(Slot));
+
+    std::vector<Slot *> slabs;
+    Slot *freeList = nullptr;
+    // Slots handed out from slabs.back(); NODES_PER_SLAB means "need a slab".
+    std::size_t used = NODES_PER_SLAB;
+}; // NodeArena
+
+
+// A node allocator that goes straight to new/delete, for comparison with
+// NodeArena and for node types that must not share storage.
+template<typename NODE>
+class NewDeleteNodes {
+public:
+    static constexpr bool bulk_release = false;
+
+    template<typename... Args>
+    NODE *create(Args &&... args) {
+        return new NODE(std::forward<Args>(args)...);
+    } // create()
+
+    void destroy(NODE *node) {
+        delete node;
+    } // destroy()
+
+    void release() {
+    } // release()
+
+    void adopt(NewDeleteNodes &&) {
+    } // adopt()
+
+    void swap(NewDeleteNodes &) noexcept {
+    } // swap()
+}; // NewDeleteNodes
+
+#endif // NODEARENA_H
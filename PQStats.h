@@ -0,0 +1,82 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef PQSTATS_H
+#define PQSTATS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Statistics policies for the priority queue engines.
+//
+// Every engine takes a STATS template parameter (the last one) and calls its
+// hooks from the places that do the work:
+//   onCompare()         once per call of the comparison functor
+//   onMove(count)       for elements moved or swapped inside the queue
+//   onAllocate()        once per node allocated (node-based engines only)
+//   onSift(depth)       once per sift-up or sift-down, with the number of
+//                       levels it moved the element
+// The hooks are const so that they may be called from const members such as
+// top(); a counting policy keeps its counters mutable.  Read them back with
+// the engine's stats() accessor.
+//
+// NoStats is the default.  Its hooks are empty inline functions and the
+// engines inherit it as an empty base, so an uninstrumented queue is the
+// same size and runs the same code as one without the policy at all.
+
+
+struct NoStats {
+    static constexpr bool enabled = false;
+
+    void onCompare() const {}
+    void onMove(std::size_t = 1) const {}
+    void onAllocate() const {}
+    void onSift(std::size_t) const {}
+}; // NoStats
+
+
+// Counts every hook call.  Intended for tuning expensive comparators, where
+// the number of comparisons matters more than wall-clock time.
+class CountingStats {
+public:
+    static constexpr bool enabled = true;
+
+    void onCompare() const { ++compareCount; }
+    void onMove(std::size_t count = 1) const { moveCount += count; }
+    void onAllocate() const { ++allocationCount; }
+
+    void onSift(std::size_t depth) const {
+        ++siftCount;
+        siftDepthTotal += depth;
+        siftDepthMax = std::max<std::uint64_t>(siftDepthMax, depth);
+    } // onSift()
+
+    std::uint64_t comparisons() const { return compareCount; }
+    std::uint64_t moves() const { return moveCount; }
+    std::uint64_t allocations() const { return allocationCount; }
+    std::uint64_t sifts() const { return siftCount; }
+    std::uint64_t siftDepthSum() const { return siftDepthTotal; }
+    std::uint64_t maxSiftDepth() const { return siftDepthMax; }
+
+    // Description: Average number of levels per sift, 0 if there were none.
+    double meanSiftDepth() const {
+        return siftCount == 0 ? 0.0 : double(siftDepthTotal) / double(siftCount);
+    } // meanSiftDepth()
+
+    // Description: Zero every counter, e.g. after filling a queue so that only
+    //              the operations of interest are measured.
+    void reset() const {
+        compareCount = moveCount = allocationCount = 0;
+        siftCount = siftDepthTotal = siftDepthMax = 0;
+    } // reset()
+
+private:
+    mutable std::uint64_t compareCount = 0;
+    mutable std::uint64_t moveCount = 0;
+    mutable std::uint64_t allocationCount = 0;
+    mutable std::uint64_t siftCount = 0;
+    mutable std::uint64_t siftDepthTotal = 0;
+    mutable std::uint64_t siftDepthMax = 0;
+}; // CountingStats
+
+#endif // PQSTATS_H
@@ -3,15 +3,47 @@
 #ifndef PAIRINGPQ_H
 #define PAIRINGPQ_H
 
-#include "Eecs281PQ.h"
+#include "Eecs281StaticPQ.h"
+#include "NodeArena.h"
+#include "Snapshot.h"
+#include <cassert>
+#include <cstdint>
 #include <deque>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+// Strategies for combining the root's children into one tree during pop().
+// See the Fredman et al. and Stasko & Vitter papers for the analysis.
+//   TwoPassPairing:    meld children in pairs left to right, then meld the
+//                      pairs right to left into one tree.
+//   MultipassPairing:  repeatedly meld the first two trees of the list and
+//                      append the result to the end, until one tree is left.
+//   AuxTwoPassPairing: the children linked onto the root since the previous
+//                      pop() (the "auxiliary" list) are first combined by
+//                      multipass, then the whole list is combined by two-pass.
+struct TwoPassPairing {};
+struct MultipassPairing {};
+struct AuxTwoPassPairing {};
+
 
 // A specialized version of the 'priority queue' ADT implemented as a pairing heap.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class PairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// Nodes come from NODE_ALLOC (see NodeArena.h); the default NodeArena recycles
+// them in slabs instead of calling new/delete for every element.  PAIRING
+// selects how pop() combines the root's children.  STATS is a statistics
+// policy from PQStats.h; a pairing heap has no sifts, so it reports
+// comparisons, node allocations and element moves only.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         template<typename> class NODE_ALLOC = NodeArena,
+         typename PAIRING = TwoPassPairing, typename STATS = NoStats>
+class PairingPQ final
+    : public Eecs281StaticPQ<PairingPQ<TYPE, COMP_FUNCTOR, NODE_ALLOC, PAIRING, STATS>,
+                             TYPE, COMP_FUNCTOR, STATS> {
     // This is a way to refer to the base class object.
-    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+    using BaseClass = Eecs281StaticPQ<PairingPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
 
 public:
     // Each node within the pairing heap
@@ -20,7 +52,14 @@ public:
             // TODO: After you add add one extra pointer (see below), be sure to
             // initialize it here.
             explicit Node(const TYPE &val)
-                : elt{ val }, child{ nullptr }, sibling{ nullptr }, parent{ nullptr }
+                : elt{ val }, child{ nullptr }, sibling{ nullptr }, prev{ nullptr }
+            {}
+            explicit Node(TYPE &&val)
+                : elt{ std::move(val) }, child{ nullptr }, sibling{ nullptr }, prev{ nullptr }
+            {}
+            template<typename... Args>
+            explicit Node(std::in_place_t, Args &&... args)
+                : elt(std::forward<Args>(args)...), child{ nullptr }, sibling{ nullptr }, prev{ nullptr }
             {}
 
             // Description: Allows access to the element at that Node's position.
@@ -39,8 +78,9 @@ public:
             TYPE elt;
             Node *child;
             Node *sibling;
-            Node *parent;
-            // TODO: Add one extra pointer (parent or previous) as desired.
+            // The left sibling, or the parent for a leftmost child, so a node
+            // unlinks itself from its sibling list in O(1).  nullptr at the root.
+            Node *prev;
     }; // Node
 
 
@@ -95,33 +135,18 @@ public:
         PairingPQ temp(rhs);
         std::swap(numNodes, temp.numNodes);
         std::swap(root, temp.root);
+        std::swap(auxCount, temp.auxCount);
+        nodes.swap(temp.nodes);
+        dirty.clear();
         return *this;
     } // operator=()
 
 
-    // Description: Destructor
-    // Runtime: O(n)
+    // Description: Destructor.  With a bulk-release allocator and a trivially
+    //              destructible TYPE, no node is visited at all.
+    // Runtime: O(n), or O(number of slabs) in the bulk case.
     ~PairingPQ() {
-        if (!empty()) {
-            std::deque<Node*> data;
-            data.push_back(root);
-            while (!data.empty()) {
-                if (data.front()->sibling != nullptr) {
-                    data.push_back(data.front()->sibling);
-                }
-                if (data.front()->child != nullptr) {
-                    data.push_back(data.front()->child);
-                }
-                Node* temp = data.front();
-                temp->parent = nullptr;
-                temp->sibling = nullptr;
-                temp->child = nullptr;
-                data.pop_front();
-                delete temp;
-            }
-            root = nullptr;
-            numNodes = 0;
-        }
+        releaseNodes();
     } // ~PairingPQ()
 
 
@@ -130,6 +155,7 @@ public:
     //              You CANNOT delete 'old' nodes and create new ones!
     // Runtime: O(n)
     virtual void updatePriorities() {
+        dirty.clear();
         if (!empty()) {
             std::deque<Node*> data;
             data.push_back(root);
@@ -145,11 +171,10 @@ public:
                     data.push_back(cur->child);
                     cur->child = nullptr;
                 }
-                if (cur->parent != nullptr) {
-                    cur->parent = nullptr;
-                }
+                cur->prev = nullptr;
                 root = meld(root, cur);
             }
+            auxCount = 0;
         }
     } // updatePriorities()
 
@@ -163,41 +188,48 @@ public:
     } // push()
 
 
+    // Description: Add a new element to the pairing heap, moving it in.
+    // Runtime: O(1)
+    virtual void push(TYPE &&val) {
+        addNode(std::move(val));
+    } // push()
+
+
+    // Description: Construct a new element directly inside a new Node.
+    // Runtime: O(1)
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        linkNode(createNode(std::in_place, std::forward<Args>(args)...));
+    } // emplace()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the pairing heap.
     // Note: We will not run tests on your code that would require it to pop an
     // element when the pairing heap is empty. Though you are welcome to if you are
     // familiar with them, you do not need to use exceptions in this project.
-    // Runtime: Amortized O(log(n))
+    // Runtime: Amortized O(log(n)).  No memory is allocated; the children are
+    //          combined in place through their sibling links.
     virtual void pop() {
         if (!empty()) {
             Node* temp = root;
-            std::deque<Node*> dq;
-            if (temp->child != nullptr) {
-                dq.push_back(temp->child);
-                if (dq.back()->sibling == nullptr) {
-                    dq.back()->parent = nullptr;
-                }
-                while (dq.back()->sibling != nullptr) {
-                    dq.push_back(dq.back()->sibling);
-                    dq[dq.size() - 2]->parent = nullptr;
-                    dq[dq.size() - 2]->sibling = nullptr;
-                }
-            }
-            temp->parent = nullptr;
-            temp->sibling = nullptr;
-            temp->child = nullptr;
-            delete temp;
-            root = nullptr;
+            root = combine(temp->child);
+            auxCount = 0;
+            nodes.destroy(temp);
             --numNodes;
-            while (dq.size() > 1) {
-                dq.push_back(meld(dq[0], dq[1]));
-                dq.pop_front(); dq.pop_front();
-            }
-            root = dq.front();
         }
     } // pop()
 
+
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the root Node before the Node is deleted.
+    // Runtime: Amortized O(log(n))
+    virtual TYPE pop_value() {
+        TYPE val = std::move(root->elt);
+        pop();
+        return val;
+    } // pop_value()
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the heap.  This should be a reference for speed.  It MUST be
     //              const because we cannot allow it to be modified, as that
@@ -221,37 +253,152 @@ public:
     } // empty()
 
 
+    // Description: Move every element of 'other' into this pairing heap and
+    //              leave 'other' empty.  No Node is copied or reallocated: the
+    //              two roots are melded and this heap's allocator takes over
+    //              other's storage, so Node pointers from other stay valid.
+    //              Both heaps must use equivalent comparison functors.
+    // Runtime: O(1), plus O(number of slabs) for the default NodeArena.
+    void merge(PairingPQ &&other) {
+        if (&other == this || other.empty()) {
+            return;
+        }
+        nodes.adopt(std::move(other.nodes));
+        if (empty()) {
+            root = other.root;
+            auxCount = other.auxCount;
+        }
+        else {
+            meldIntoRoot(other.root);
+        }
+        numNodes += other.numNodes;
+        dirty.insert(dirty.end(), other.dirty.begin(), other.dirty.end());
+        other.dirty.clear();
+        other.root = nullptr;
+        other.numNodes = 0;
+        other.auxCount = 0;
+    } // merge()
+
+
     // Description: Updates the priority of an element already in the pairing heap by
     //              replacing the element refered to by the Node with new_value.
-    //              Must maintain pairing heap invariants.
+    //              Must maintain pairing heap invariants.  The node is cut out
+    //              of its sibling list and melded with the root.
     //
     // PRECONDITION: The new priority, given by 'new_value' must be more extreme
-    //               (as defined by comp) than the old priority.
+    //               (as defined by comp) than the old priority.  A less extreme
+    //               value is handed on to worsenElt() rather than ignored.
     //
-    // Runtime: As discussed in reading material.
-    // TODO: when you implement this function, uncomment the parameter names.
+    // Runtime: O(1), plus O(log(n)) amortized for a less extreme value.
     void updateElt(Node* node, const TYPE &new_value) {
-        if (node != nullptr && this->compare(node->elt, new_value)) {
-            node->elt = new_value;
-            if (root != node && this->compare(node->parent->elt, new_value)) {
-                if (node->parent->child == node) {
-                    node->parent->child = node->sibling;
-                }
-                else {
-                    Node* i = node->parent->child;
-                    while (i->sibling != node) {
-                        i = i->sibling;
-                    }
-                    i->sibling = node->sibling;
-                }
-                node->parent = nullptr;
-                node->sibling = nullptr;
-                root = meld(root, node);
-            }
+        if (node == nullptr) {
+            return;
+        }
+        if (!this->countedCompare(node->elt, new_value)) {
+            worsenElt(node, new_value);
+            return;
+        }
+        node->elt = new_value;
+        this->stats().onMove();
+        if (node != root) {
+            detach(node);
+            meldIntoRoot(node);
         }
     } // updateElt()
 
 
+    // Description: Replace the element of 'node' with a value that is not more
+    //              extreme than the old one.  The node's children may now beat
+    //              it, so they are paired into one tree that is melded with the
+    //              root, leaving the node a leaf where it was.
+    // Runtime: Amortized O(log(n))
+    void worsenElt(Node* node, const TYPE &new_value) {
+        if (node == nullptr) {
+            return;
+        }
+        node->elt = new_value;
+        this->stats().onMove();
+        Node* tree = pairChildren(node);
+        if (tree == nullptr) {
+            return;
+        }
+        if (node == root) {
+            // The old root is now a single node; the subtree takes its place
+            // and the node goes back in as an ordinary child.
+            root = tree;
+            auxCount = 0;
+            meldIntoRoot(node);
+        }
+        else {
+            meldIntoRoot(tree);
+        }
+    } // worsenElt()
+
+
+    // Description: Replace the element of 'node' with 'new_value', which may
+    //              be more or less extreme than the old one.
+    // Runtime: O(1) for a more extreme value, amortized O(log(n)) otherwise.
+    void changeElt(Node* node, const TYPE &new_value) {
+        if (node != nullptr && this->countedCompare(node->elt, new_value)) {
+            updateElt(node, new_value);
+        }
+        else {
+            worsenElt(node, new_value);
+        }
+    } // changeElt()
+
+
+    // Description: Remove the element of 'node' from the pairing heap, wherever
+    //              it is.  The node is cut out of its sibling list, its
+    //              children are paired into one tree and that tree is melded
+    //              with the root; the rest of the heap is not touched.  'node'
+    //              is invalid afterwards.
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
+        if (node == root) {
+            pop();
+            return;
+        }
+        detach(node);
+        Node* tree = pairChildren(node);
+        if (tree != nullptr) {
+            meldIntoRoot(tree);
+        }
+        nodes.destroy(node);
+        --numNodes;
+    } // erase()
+
+
+    // Description: Record that the priority of the element in 'node' has
+    //              changed (for instance, the value a pointer element points
+    //              to).  Nothing moves until updateDirty(); the node must not
+    //              be popped or erased before then.
+    // Runtime: O(1)
+    void markDirty(Node* node) {
+        dirty.push_back(node);
+    } // markDirty()
+
+
+    // Description: Repair the heap after the priorities of the nodes given
+    //              to markDirty() changed.  Each one is cut out with its
+    //              subtree, its children are paired into one tree, and the
+    //              node and that tree are melded with the root; untouched
+    //              parts of the heap stay linked as they are.  Past
+    //              1 / DIRTY_REBUILD of the heap, updatePriorities() is used
+    //              instead.
+    // Runtime: Amortized O(d log(n)) for d dirty nodes.
+    void updateDirty() {
+        if (dirty.size() * DIRTY_REBUILD > size()) {
+            updatePriorities();
+            return;
+        }
+        for (Node* node : dirty) {
+            repairNode(node);
+        }
+        dirty.clear();
+    } // updateDirty()
+
+
     // Description: Add a new element to the pairing heap. Returns a Node* corresponding
     //              to the newly added element.
     // Runtime: O(1)
@@ -261,21 +408,391 @@ public:
     //       by the user calling pop().  Remember this when you implement updateElt() and
     //       updatePriorities().
     Node* addNode(const TYPE &val) {
-        Node* newVal = new Node(val);
+        return linkNode(createNode(val));
+    } // addNode()
+
+
+    // Description: Same as above, but moves 'val' into the new Node.
+    // Runtime: O(1)
+    Node* addNode(TYPE &&val) {
+        return linkNode(createNode(std::move(val)));
+    } // addNode()
+
+
+    // Description: Write the tree to a Pairing image at 'path' (see
+    //              Snapshot.h): the elements in preorder of the child and
+    //              sibling links, then one byte per node saying whether it
+    //              has a child and a sibling.  TYPE must be trivially copyable.
+    // Runtime: O(n)
+    void snapshot(const std::string &path) const {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots write elements as raw bytes");
+        std::vector<std::uint8_t> links;
+        links.reserve(size());
+        SnapshotWriter out{ path, SnapshotFormat::Pairing, sizeof(TYPE), size(), size() };
+        // Elements go out a chunk at a time, not one fwrite() per node.
+        std::vector<TYPE> chunk;
+        chunk.reserve(SNAPSHOT_CHUNK);
+        std::vector<const Node*> work;
+        if (root != nullptr)
+            work.push_back(root);
+        while (!work.empty()) {
+            const Node* cur = work.back();
+            work.pop_back();
+            chunk.push_back(cur->elt);
+            if (chunk.size() == SNAPSHOT_CHUNK) {
+                out.write(chunk.data(), chunk.size() * sizeof(TYPE));
+                chunk.clear();
+            }
+            std::uint8_t flags = 0;
+            // The child is visited before the sibling.
+            if (cur->sibling != nullptr) {
+                flags |= SNAPSHOT_HAS_SIBLING;
+                work.push_back(cur->sibling);
+            }
+            if (cur->child != nullptr) {
+                flags |= SNAPSHOT_HAS_CHILD;
+                work.push_back(cur->child);
+            }
+            links.push_back(flags);
+        }
+        out.write(chunk.data(), chunk.size() * sizeof(TYPE));
+        out.write(links.data(), links.size());
+        out.finish();
+    } // snapshot()
+
+
+    // Description: Replace the contents with the Pairing image at 'path',
+    //              rebuilding the same tree node for node, with no melds and
+    //              so no comparisons.  The image must come from a heap with
+    //              the same order; debug builds check the heap invariant.
+    // Runtime: O(n)
+    void restore(const std::string &path) {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots read elements as raw bytes");
+        static_assert(alignof(TYPE) <= sizeof(SnapshotHeader), "snapshot elements follow the header");
+        SnapshotImage image{ path, SnapshotFormat::Pairing, sizeof(TYPE) };
+        const std::size_t count = image.count();
+        const std::uint8_t* links = image.extra();
+        if (image.extraBytes() != count || !validLinks(links, count))
+            image.malformed("does not hold a pairing heap");
+
+        releaseNodes();
+        dirty.clear();
+        auxCount = 0;
+        const TYPE* elts = image.elements<TYPE>();
+        // Nodes whose sibling has not been read yet, innermost last.
+        std::vector<Node*> pending;
+        Node* last = nullptr;
+        for (std::size_t i = 0; i < count; ++i) {
+            Node* node = createNode(elts[i]);
+            if (last == nullptr) {
+                root = node;
+            }
+            else if (links[i - 1] & SNAPSHOT_HAS_CHILD) {
+                last->child = node;
+                node->prev = last;
+            }
+            else {
+                pending.back()->sibling = node;
+                node->prev = pending.back();
+                pending.pop_back();
+            }
+            if (links[i] & SNAPSHOT_HAS_SIBLING) {
+                pending.push_back(node);
+            }
+            last = node;
+            ++numNodes;
+        }
+        this->stats().onMove(count);
+        assert(isHeapOrdered() && "snapshot is not a pairing heap in this order");
+    } // restore()
+
+
+protected:
+    // Description: Build a Node for every element, link them into one sibling
+    //              list, two-pass pair that list into a single tree, and meld the tree
+    //              into the heap with one meld.
+    // Runtime: O(k) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        Node* first = nullptr;
+        for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+            Node* node = createNode(std::move(*it));
+            node->sibling = first;
+            first = node;
+        }
+        if (first != nullptr) {
+            Node* tree = twoPass(first);
+            if (empty()) {
+                root = tree;
+            }
+            else {
+                meldIntoRoot(tree);
+            }
+            numNodes += int(batch.size());
+        }
+    } // pushBatch()
+
+
+private:
+    Node* root = nullptr;
+    int numNodes = 0;
+    NODE_ALLOC<Node> nodes;
+    // Number of children linked onto the root since the last pop(), at the
+    // front of its child list.  Only AuxTwoPassPairing uses it.
+    int auxCount = 0;
+    // Nodes given to markDirty() since the last repair.
+    std::vector<Node*> dirty;
+    // updateDirty() rebuilds the whole heap once more than 1 / DIRTY_REBUILD
+    // of it is dirty, where cutting out node after node costs more than
+    // updatePriorities() melding every node once.
+    static constexpr std::size_t DIRTY_REBUILD = 8;
+    // Elements per write in snapshot().
+    static constexpr std::size_t SNAPSHOT_CHUNK = 4096;
+
+    // Call fn on every Node exactly once.  Links are read before fn runs, so
+    // fn may destroy the Node.  Each child list is spliced onto the front of
+    // the work list through the sibling pointers, so nothing is allocated.
+    template<typename FUNC>
+    void forEachNode(FUNC fn) {
+        Node* work = root;
+        while (work != nullptr) {
+            Node* cur = work;
+            work = cur->sibling;
+            if (cur->child != nullptr) {
+                Node* last = cur->child;
+                while (last->sibling != nullptr) {
+                    last = last->sibling;
+                }
+                last->sibling = work;
+                work = cur->child;
+            }
+            fn(cur);
+        }
+    } // forEachNode()
+
+    // Destroy every Node and leave the heap empty.  With a bulk-release
+    // allocator and a trivially destructible TYPE, no node is visited at all.
+    void releaseNodes() {
+        if (NODE_ALLOC<Node>::bulk_release) {
+            if (!std::is_trivially_destructible<TYPE>::value)
+                forEachNode([](Node* node) { node->~Node(); });
+            nodes.release();
+        }
+        else {
+            forEachNode([this](Node* node) { nodes.destroy(node); });
+        }
+        root = nullptr;
+        numNodes = 0;
+    } // releaseNodes()
+
+    // Whether the preorder link flags of a Pairing image describe one tree
+    // of 'count' nodes: the root has no sibling, each node without a child
+    // is followed by the sibling of an open node, and none is left open.
+    static bool validLinks(const std::uint8_t* links, std::size_t count) {
+        if (count == 0) {
+            return true;
+        }
+        if (links[0] & SNAPSHOT_HAS_SIBLING) {
+            return false;
+        }
+        std::size_t pending = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if ((links[i] & ~(SNAPSHOT_HAS_CHILD | SNAPSHOT_HAS_SIBLING)) != 0) {
+                return false;
+            }
+            if (i > 0 && !(links[i - 1] & SNAPSHOT_HAS_CHILD)) {
+                if (pending == 0) {
+                    return false;
+                }
+                --pending;
+            }
+            if (links[i] & SNAPSHOT_HAS_SIBLING) {
+                ++pending;
+            }
+        }
+        return pending == 0 && !(links[count - 1] & SNAPSHOT_HAS_CHILD);
+    } // validLinks()
+
+    // Whether no child is more extreme than its parent, for debug checks.
+    bool isHeapOrdered() const {
+        std::vector<const Node*> work;
+        if (root != nullptr) {
+            work.push_back(root);
+        }
+        while (!work.empty()) {
+            const Node* cur = work.back();
+            work.pop_back();
+            for (const Node* child = cur->child; child != nullptr; child = child->sibling) {
+                if (this->compare(cur->elt, child->elt)) {
+                    return false;
+                }
+                work.push_back(child);
+            }
+        }
+        return true;
+    } // isHeapOrdered()
+
+    // Allocate a Node from 'nodes', reporting it to the statistics policy.
+    template<typename... Args>
+    Node* createNode(Args &&... args) {
+        this->stats().onAllocate();
+        return nodes.create(std::forward<Args>(args)...);
+    } // createNode()
+
+    // Meld a freshly created Node into the heap and count it.
+    Node* linkNode(Node* newVal) {
         if (empty()) {
             root = newVal;
         }
         else {
-            root = meld(root, newVal);
+            meldIntoRoot(newVal);
         }
         ++numNodes;
         return newVal;
-    } // addNode()
+    } // linkNode()
+
+    // Meld a detached tree into the heap, keeping count of the auxiliary
+    // list: either the tree became the root's first child, or the old root
+    // became the only child of the tree.
+    void meldIntoRoot(Node* tree) {
+        Node* oldRoot = root;
+        root = meld(root, tree);
+        auxCount = (root == oldRoot) ? auxCount + 1 : 1;
+    } // meldIntoRoot()
+
+    // Combine the sibling list starting at 'first' into a single tree, using
+    // the PAIRING strategy, and return its root (nullptr for an empty list).
+    Node* combine(Node* first) {
+        if (first == nullptr) {
+            return nullptr;
+        }
+        Node* result;
+        if (std::is_same<PAIRING, MultipassPairing>::value) {
+            result = multipass(first);
+        }
+        else if (std::is_same<PAIRING, AuxTwoPassPairing>::value && auxCount > 1) {
+            // Cut the auxiliary prefix off the list, combine it on its own,
+            // and put the resulting tree back in front of the older children.
+            Node* last = first;
+            for (int i = 1; i < auxCount && last->sibling != nullptr; ++i) {
+                last = last->sibling;
+            }
+            Node* rest = last->sibling;
+            last->sibling = nullptr;
+            Node* aux = multipass(first);
+            aux->sibling = rest;
+            result = twoPass(aux);
+        }
+        else {
+            result = twoPass(first);
+        }
+        result->prev = nullptr;
+        result->sibling = nullptr;
+        return result;
+    } // combine()
+
+    // Take the children of 'node' away from it, paired into a single tree
+    // (nullptr if it has none).  Only the root's child list has an
+    // auxiliary prefix, so plain two-pass pairing is used.
+    Node* pairChildren(Node* node) {
+        if (node->child == nullptr) {
+            return nullptr;
+        }
+        Node* tree = twoPass(node->child);
+        tree->prev = nullptr;
+        node->child = nullptr;
+        return tree;
+    } // pairChildren()
+
+    // Put a node whose priority changed back in order: as a single node
+    // melded with the root, its former children paired and melded likewise.
+    void repairNode(Node* node) {
+        if (node == root) {
+            Node* tree = combine(node->child);
+            if (tree != nullptr) {
+                node->child = nullptr;
+                root = tree;
+                auxCount = 0;
+                meldIntoRoot(node);
+            }
+            return;
+        }
+        detach(node);
+        Node* tree = pairChildren(node);
+        meldIntoRoot(node);
+        if (tree != nullptr) {
+            meldIntoRoot(tree);
+        }
+    } // repairNode()
 
+    // Unlink a non-root node, with its subtree, from its sibling list.
+    void detach(Node* node) {
+        if (node->prev->child == node) {
+            node->prev->child = node->sibling;
+        }
+        else {
+            node->prev->sibling = node->sibling;
+        }
+        if (node->sibling != nullptr) {
+            node->sibling->prev = node->prev;
+        }
+        node->prev = nullptr;
+        node->sibling = nullptr;
+    } // detach()
+
+    // Two-pass pairing.  The first pass melds neighbours and pushes each
+    // pair onto a stack threaded through the sibling links; popping that
+    // stack then visits the pairs right to left for the second pass.
+    Node* twoPass(Node* first) {
+        Node* pairs = nullptr;
+        while (first != nullptr) {
+            Node* a = first;
+            Node* b = a->sibling;
+            first = (b == nullptr) ? nullptr : b->sibling;
+            a->sibling = nullptr;
+            if (b != nullptr) {
+                b->sibling = nullptr;
+                a = meld(a, b);
+            }
+            a->sibling = pairs;
+            pairs = a;
+        }
+        Node* result = pairs;
+        pairs = pairs->sibling;
+        result->sibling = nullptr;
+        while (pairs != nullptr) {
+            Node* next = pairs->sibling;
+            pairs->sibling = nullptr;
+            result = meld(result, pairs);
+            pairs = next;
+        }
+        return result;
+    } // twoPass()
+
+    // Multipass pairing.  The sibling list is used as a FIFO queue: meld the
+    // first two trees and append the result at the tail.
+    Node* multipass(Node* first) {
+        Node* tail = first;
+        while (tail->sibling != nullptr) {
+            tail = tail->sibling;
+        }
+        while (first != tail) {
+            Node* a = first;
+            Node* b = a->sibling;
+            first = b->sibling;
+            a->sibling = nullptr;
+            b->sibling = nullptr;
+            Node* melded = meld(a, b);
+            if (first == nullptr) {
+                first = melded;
+            }
+            else {
+                tail->sibling = melded;
+            }
+            tail = melded;
+        }
+        return first;
+    } // multipass()
 
-private:
-    Node* root = nullptr;
-    int numNodes = 0;
     Node* meld(Node* lh, Node* rh) {
         if (lh == nullptr) {
             return rh;
@@ -283,25 +800,31 @@ private:
         else if (rh == nullptr) {
             return lh;
         }
-        else if (this->compare(lh->elt, rh->elt)) {
-            lh->parent = rh;
-            lh->sibling = rh->child;
-            rh->child = lh;
+        else if (this->countedCompare(lh->elt, rh->elt)) {
+            linkChild(rh, lh);
             return rh;
         }
         else {
-            rh->parent = lh;
-            rh->sibling = lh->child;
-            lh->child = rh;
+            linkChild(lh, rh);
             return lh;
         }
-    }
+    } // meld()
+
+    // Make 'node' the leftmost child of 'parent'.
+    void linkChild(Node* parent, Node* node) {
+        node->prev = parent;
+        node->sibling = parent->child;
+        if (parent->child != nullptr) {
+            parent->child->prev = node;
+        }
+        parent->child = node;
+    } // linkChild()
     // TODO: Add any additional member variables or member functions you require here.
     // TODO: We recommend creating a 'meld' function (see the Pairing Heap papers).
 
-    // NOTE: For member variables, you are only allowed to add a "root pointer"
-    //       and a "count" of the number of nodes.  Anything else (such as a deque)
-    //       should be declared inside of member functions as needed.
+    // NOTE: Besides the node allocator, the only member variables are a "root
+    //       pointer" and a "count" of the number of nodes.  Anything else (such
+    //       as a deque) should be declared inside of member functions as needed.
 };
 
 
@@ -0,0 +1,303 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef RADIXPQ_H
+#define RADIXPQ_H
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Eecs281StaticPQ.h"
+#include "KeyOf.h"
+
+
+// A radix heap (Ahuja, Mehlhorn, Orlin and Tarjan) for integral keys that are
+// MONOTONE: no element pushed may have a smaller key than the last element
+// popped, as in Dijkstra's algorithm or a timer wheel.  The most extreme
+// element is the one with the SMALLEST key, so RadixPQ<uint64_t> is a drop-in
+// for BinaryPQ<uint64_t, std::greater<uint64_t>> on monotone workloads.
+//
+// KEY_OF maps an element to its integral key (see KeyOf.h).
+// Signed keys are supported and ordered as usual.  COMP_FUNCTOR is kept for
+// the Eecs281PQ interface and must order the elements as std::greater orders
+// their keys; the engine itself never calls it, and works on keys only.
+//
+// Elements live in buckets by the highest bit in which their key differs from
+// 'last', the key of the most recent pop.  push() is O(1).  pop() empties the
+// lowest non-empty bucket into lower ones, and an element can only move down,
+// at most KEY_BITS times over its life, so pop() is O(KEY_BITS) amortized.
+// Only keys are compared; the comparison functor is never called.
+//
+// The precondition is checked with assert(); updatePriorities() lifts it once,
+// by rebuilding around the smallest key present.
+template<typename TYPE, typename COMP_FUNCTOR = std::greater<TYPE>,
+         typename KEY_OF = IdentityKey, typename STATS = NoStats>
+class RadixPQ final
+    : public Eecs281StaticPQ<RadixPQ<TYPE, COMP_FUNCTOR, KEY_OF, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<RadixPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+    using RawKey = std::decay_t<decltype(std::declval<KEY_OF>()(std::declval<const TYPE &>()))>;
+    static_assert(std::is_integral<RawKey>::value, "RadixPQ needs integral keys");
+
+public:
+    // The key as an unsigned integer with the same order.
+    using key_type = std::make_unsigned_t<RawKey>;
+
+    static constexpr std::size_t KEY_BITS = sizeof(key_type) * CHAR_BIT;
+    static_assert(KEY_BITS <= 64, "RadixPQ supports keys of up to 64 bits");
+
+    // Description: Construct an empty heap with an optional comparison functor
+    //              and key extractor.
+    // Runtime: O(KEY_BITS)
+    explicit RadixPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), KEY_OF keyFunc = KEY_OF()) :
+        BaseClass{ comp }, keyOf{ keyFunc } {
+    } // RadixPQ()
+
+
+    // Description: Construct a heap out of an iterator range; the keys need
+    //              not be in any order.
+    // Runtime: O(n + KEY_BITS)
+    template<typename InputIterator>
+    RadixPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+            KEY_OF keyFunc = KEY_OF()) :
+        BaseClass{ comp }, keyOf{ keyFunc } {
+        buckets[0].assign(start, end);
+        numElements = buckets[0].size();
+        updatePriorities();
+    } // RadixPQ()
+
+
+    // Description: Destructor doesn't need any code, the buckets will be
+    //              destroyed automatically.
+    virtual ~RadixPQ() {
+    } // ~RadixPQ()
+
+
+    // Description: Rebuild the buckets around the smallest key present.
+    //              Afterwards the monotone precondition is relative to that key.
+    // Runtime: O(n + KEY_BITS)
+    virtual void updatePriorities() {
+        std::vector<TYPE> all;
+        all.reserve(numElements);
+        for (std::vector<TYPE> &bucket : buckets) {
+            for (TYPE &val : bucket)
+                all.push_back(std::move(val));
+            bucket.clear();
+        }
+        nonEmpty = 0;
+        topBucket = NONE;
+        if (all.empty())
+            return;
+
+        last = std::numeric_limits<key_type>::max();
+        for (const TYPE &val : all) {
+            if (key(val) < last)
+                last = key(val);
+        }
+        for (TYPE &val : all)
+            place(std::move(val));
+    } // updatePriorities()
+
+
+    // Description: Add a new element; its key must not be below the key of
+    //              the last element popped.
+    // Runtime: O(1)
+    virtual void push(const TYPE &val) {
+        place(val);
+        ++numElements;
+    } // push()
+
+
+    // Description: Add a new element, moving it in.
+    // Runtime: O(1)
+    virtual void push(TYPE &&val) {
+        place(std::move(val));
+        ++numElements;
+    } // push()
+
+
+    // Description: Remove the element with the smallest key.
+    // Runtime: O(KEY_BITS) amortized.
+    virtual void pop() {
+        settleAtBack();
+        buckets[0].pop_back();
+        if (buckets[0].empty())
+            nonEmpty &= ~std::uint64_t(1);
+        --numElements;
+        topBucket = NONE;
+    } // pop()
+
+
+    // Description: Remove the element with the smallest key and return it.
+    // Runtime: O(KEY_BITS) amortized.
+    virtual TYPE pop_value() {
+        settleAtBack();
+        TYPE val = std::move(buckets[0].back());
+        pop();
+        return val;
+    } // pop_value()
+
+
+    // Description: Return the element with the smallest key.  The lowest
+    //              non-empty bucket is scanned once and the answer cached until
+    //              the next pop(), so top() then pop() scans only once.
+    // Runtime: O(size of the lowest non-empty bucket), O(1) when cached.
+    virtual const TYPE &top() const {
+        if (topBucket == NONE)
+            findTop();
+        return buckets[topBucket][topIndex];
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return numElements;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return numElements == 0;
+    } // empty()
+
+
+    // Description: The key of the last element popped: the lower bound for
+    //              the keys of future pushes.
+    // Runtime: O(1)
+    key_type lastKey() const {
+        return last;
+    } // lastKey()
+
+
+private:
+    static constexpr std::size_t NONE = std::size_t(-1);
+
+    // buckets[0] holds keys equal to 'last'; buckets[b] for b >= 1 holds keys
+    // whose highest bit differing from 'last' is bit b - 1.
+    std::vector<TYPE> buckets[KEY_BITS + 1];
+    // Bit b is set when buckets[b] is non-empty.  With 64-bit keys the top
+    // bucket has no bit; it is the one left when the mask is zero.
+    std::uint64_t nonEmpty = 0;
+    key_type last = 0;
+    std::size_t numElements = 0;
+    KEY_OF keyOf;
+    // Where top() found the smallest key, or NONE if not known.
+    mutable std::size_t topBucket = NONE;
+    mutable std::size_t topIndex = 0;
+
+    key_type key(const TYPE &val) const {
+        RawKey raw = keyOf(val);
+        if (std::is_signed<RawKey>::value)
+            return key_type(key_type(raw) ^ (key_type(1) << (KEY_BITS - 1)));
+        return key_type(raw);
+    } // key()
+
+    // Number of significant bits in a non-zero x.
+    static std::size_t bitWidth(key_type x) {
+        return 64 - std::size_t(__builtin_clzll(std::uint64_t(x)));
+    } // bitWidth()
+
+    std::size_t bucketOf(key_type k) const {
+        return k == last ? 0 : bitWidth(key_type(k ^ last));
+    } // bucketOf()
+
+    void markNonEmpty(std::size_t b) {
+        if (b < 64)
+            nonEmpty |= std::uint64_t(1) << b;
+    } // markNonEmpty()
+
+    // The lowest non-empty bucket; the heap must not be empty.
+    std::size_t lowestBucket() const {
+        if (nonEmpty != 0)
+            return std::size_t(__builtin_ctzll(nonEmpty));
+        return KEY_BITS;
+    } // lowestBucket()
+
+    template<typename VALUE>
+    void place(VALUE &&val) {
+        const key_type k = key(val);
+        assert(k >= last && "RadixPQ keys must not go below the last popped key");
+        const std::size_t b = bucketOf(k);
+        buckets[b].push_back(std::forward<VALUE>(val));
+        markNonEmpty(b);
+        // A cached top stays valid unless the new element beats it.
+        if (topBucket != NONE && k < key(buckets[topBucket][topIndex])) {
+            topBucket = b;
+            topIndex = buckets[b].size() - 1;
+        }
+    } // place()
+
+    // Find the smallest key: anything in bucket 0, otherwise the minimum of
+    // the lowest non-empty bucket.
+    void findTop() const {
+        const std::size_t b = lowestBucket();
+        const std::vector<TYPE> &bucket = buckets[b];
+        std::size_t best = bucket.size() - 1;
+        if (b != 0) {
+            key_type bestKey = key(bucket[best]);
+            for (std::size_t i = 0; i + 1 < bucket.size(); ++i) {
+                this->stats().onCompare();
+                if (key(bucket[i]) < bestKey) {
+                    bestKey = key(bucket[i]);
+                    best = i;
+                }
+            }
+        }
+        topBucket = b;
+        topIndex = best;
+    } // findTop()
+
+    // Make bucket 0 hold the smallest key: advance 'last' to it and spread
+    // its bucket over the lower buckets.  Every element there moves to a
+    // strictly lower bucket.  The cached top is followed into bucket 0, so
+    // top() names the same element before and after.
+    void settle() {
+        if (topBucket == NONE)
+            findTop();
+        const std::size_t b = topBucket;
+        if (b == 0)
+            return;
+        const std::size_t topAt = topIndex;
+        last = key(buckets[b][topAt]);
+        topBucket = NONE;
+        std::vector<TYPE> moving;
+        moving.swap(buckets[b]);
+        if (b < 64)
+            nonEmpty &= ~(std::uint64_t(1) << b);
+        for (std::size_t i = 0; i < moving.size(); ++i) {
+            this->stats().onMove();
+            place(std::move(moving[i]));
+            if (i == topAt)
+                topIndex = buckets[0].size() - 1;
+        }
+        topBucket = 0;
+        // Hand the storage back so the bucket does not reallocate next time.
+        moving.clear();
+        buckets[b].swap(moving);
+    } // settle()
+
+    // settle(), then swap the cached top to the back of bucket 0, where
+    // pop() takes it from.  Elements with equal keys may sit after it.
+    void settleAtBack() {
+        settle();
+        std::vector<TYPE> &bucket = buckets[0];
+        if (topIndex != bucket.size() - 1) {
+            using std::swap;
+            swap(bucket[topIndex], bucket.back());
+            this->stats().onMove();
+            topIndex = bucket.size() - 1;
+        }
+    } // settleAtBack()
+}; // RadixPQ
+
+#endif // RADIXPQ_H
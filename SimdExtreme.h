@@ -0,0 +1,380 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef SIMDEXTREME_H
+#define SIMDEXTREME_H
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMDEXTREME_X86 1
+#else
+#define SIMDEXTREME_X86 0
+#endif
+
+// Vectorized search for the most extreme element of an array, for the
+// unordered engines' findExtreme().  SimdExtreme<TYPE, COMP>::supported is
+// true for int and float compared by std::less (find the maximum) or
+// std::greater (find the minimum); find() then returns the same index as
+// the engines' scalar loop, the FIRST most extreme element, or NONE when
+// the caller should run that loop itself:
+//   - on CPUs without SSE4.1, and on compilers or targets other than
+//     GCC/Clang on x86, where only the scalar loop exists;
+//   - for arrays shorter than MIN_SIMD, where the loop is faster;
+//   - for floats when the array holds a NaN, which has no place in the
+//     order the loop sees.
+//
+// The kernel is picked once per TYPE and direction at run time: AVX2 (8
+// lanes, 32 elements per iteration) or SSE4.1 (4 lanes, 16 elements per
+// iteration), whatever the rest of the program was compiled for.  The first
+// pass reduces the array to its extreme value; the second finds the first
+// index holding it.
+template<typename TYPE, typename COMP>
+struct SimdExtreme {
+    static constexpr bool supported = false;
+};
+
+
+// The kernels, for one element type and direction (MAX finds the maximum).
+template<typename TYPE, bool MAX>
+struct SimdExtremeKernels {
+    static constexpr bool supported = false;
+};
+
+
+#if SIMDEXTREME_X86
+
+template<bool MAX>
+struct SimdExtremeKernels<int, MAX> {
+    static constexpr bool supported = sizeof(int) == 4;
+    static constexpr std::size_t NONE = std::size_t(-1);
+
+    [[gnu::target("avx2")]] static std::size_t avx2(const int *data, std::size_t n) {
+        __m256i acc[4];
+        for (__m256i &a : acc)
+            a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            for (std::size_t a = 0; a < 4; ++a)
+                acc[a] = better256(acc[a], load256(data + i + 8 * a));
+        }
+        for (; i + 8 <= n; i += 8)
+            acc[0] = better256(acc[0], load256(data + i));
+        __m256i all = better256(better256(acc[0], acc[1]), better256(acc[2], acc[3]));
+        __m128i half = better128(_mm256_castsi256_si128(all), _mm256_extracti128_si256(all, 1));
+        int best = reduce128(half);
+        for (; i < n; ++i)
+            best = better(best, data[i]);
+
+        const __m256i target = _mm256_set1_epi32(best);
+        std::size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256i eq = _mm256_cmpeq_epi32(load256(data + j), target);
+            unsigned mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+            if (mask != 0)
+                return j + std::size_t(__builtin_ctz(mask));
+        }
+        return firstOf(data, j, n, best);
+    } // avx2()
+
+    [[gnu::target("sse4.1")]] static std::size_t sse41(const int *data, std::size_t n) {
+        __m128i acc[4];
+        for (__m128i &a : acc)
+            a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            for (std::size_t a = 0; a < 4; ++a)
+                acc[a] = better128(acc[a], load128(data + i + 4 * a));
+        }
+        for (; i + 4 <= n; i += 4)
+            acc[0] = better128(acc[0], load128(data + i));
+        int best = reduce128(better128(better128(acc[0], acc[1]), better128(acc[2], acc[3])));
+        for (; i < n; ++i)
+            best = better(best, data[i]);
+
+        const __m128i target = _mm_set1_epi32(best);
+        std::size_t j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m128i eq = _mm_cmpeq_epi32(load128(data + j), target);
+            unsigned mask = unsigned(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+            if (mask != 0)
+                return j + std::size_t(__builtin_ctz(mask));
+        }
+        return firstOf(data, j, n, best);
+    } // sse41()
+
+    [[gnu::target("avx2")]] static std::size_t beatingAvx2(const int *data, std::size_t from,
+                                                           std::size_t n, int bar) {
+        const __m256i target = _mm256_set1_epi32(bar);
+        for (; from + 8 <= n; from += 8) {
+            __m256i v = load256(data + from);
+            __m256i gt = MAX ? _mm256_cmpgt_epi32(v, target) : _mm256_cmpgt_epi32(target, v);
+            unsigned mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+            if (mask != 0)
+                return from + std::size_t(__builtin_ctz(mask));
+        }
+        return beatingScalar(data, from, n, bar);
+    } // beatingAvx2()
+
+    [[gnu::target("sse4.1")]] static std::size_t beatingSse41(const int *data, std::size_t from,
+                                                              std::size_t n, int bar) {
+        const __m128i target = _mm_set1_epi32(bar);
+        for (; from + 4 <= n; from += 4) {
+            __m128i v = load128(data + from);
+            __m128i gt = MAX ? _mm_cmpgt_epi32(v, target) : _mm_cmpgt_epi32(target, v);
+            unsigned mask = unsigned(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+            if (mask != 0)
+                return from + std::size_t(__builtin_ctz(mask));
+        }
+        return beatingScalar(data, from, n, bar);
+    } // beatingSse41()
+
+private:
+    static int better(int a, int b) {
+        return MAX ? (a < b ? b : a) : (b < a ? b : a);
+    } // better()
+
+    static std::size_t beatingScalar(const int *data, std::size_t from, std::size_t n, int bar) {
+        while (from < n && !(MAX ? bar < data[from] : data[from] < bar))
+            ++from;
+        return from;
+    } // beatingScalar()
+
+    static std::size_t firstOf(const int *data, std::size_t from, std::size_t n, int best) {
+        while (from < n && data[from] != best)
+            ++from;
+        return from;
+    } // firstOf()
+
+    [[gnu::target("avx2")]] static __m256i load256(const int *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    } // load256()
+
+    [[gnu::target("avx2")]] static __m256i better256(__m256i a, __m256i b) {
+        return MAX ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+    } // better256()
+
+    [[gnu::target("sse4.1")]] static __m128i load128(const int *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    } // load128()
+
+    [[gnu::target("sse4.1")]] static __m128i better128(__m128i a, __m128i b) {
+        return MAX ? _mm_max_epi32(a, b) : _mm_min_epi32(a, b);
+    } // better128()
+
+    [[gnu::target("sse4.1")]] static int reduce128(__m128i v) {
+        v = better128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = better128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(v);
+    } // reduce128()
+}; // SimdExtremeKernels<int>
+
+
+template<bool MAX>
+struct SimdExtremeKernels<float, MAX> {
+    static constexpr bool supported = true;
+    static constexpr std::size_t NONE = std::size_t(-1);
+
+    [[gnu::target("avx2")]] static std::size_t avx2(const float *data, std::size_t n) {
+        __m256 acc[4];
+        __m256 nan = _mm256_setzero_ps();
+        for (__m256 &a : acc)
+            a = _mm256_loadu_ps(data);
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            for (std::size_t a = 0; a < 4; ++a) {
+                __m256 v = _mm256_loadu_ps(data + i + 8 * a);
+                nan = _mm256_or_ps(nan, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+                acc[a] = better256(acc[a], v);
+            }
+        }
+        for (; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_loadu_ps(data + i);
+            nan = _mm256_or_ps(nan, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+            acc[0] = better256(acc[0], v);
+        }
+        if (_mm256_movemask_ps(nan) != 0)
+            return NONE;
+        __m256 all = better256(better256(acc[0], acc[1]), better256(acc[2], acc[3]));
+        __m128 half = better128(_mm256_castps256_ps128(all), _mm256_extractf128_ps(all, 1));
+        float best = reduce128(half);
+        for (; i < n; ++i) {
+            if (data[i] != data[i])
+                return NONE;
+            best = better(best, data[i]);
+        }
+
+        const __m256 target = _mm256_set1_ps(best);
+        std::size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256 eq = _mm256_cmp_ps(_mm256_loadu_ps(data + j), target, _CMP_EQ_OQ);
+            unsigned mask = unsigned(_mm256_movemask_ps(eq));
+            if (mask != 0)
+                return j + std::size_t(__builtin_ctz(mask));
+        }
+        return firstOf(data, j, n, best);
+    } // avx2()
+
+    [[gnu::target("sse4.1")]] static std::size_t sse41(const float *data, std::size_t n) {
+        __m128 acc[4];
+        __m128 nan = _mm_setzero_ps();
+        for (__m128 &a : acc)
+            a = _mm_loadu_ps(data);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            for (std::size_t a = 0; a < 4; ++a) {
+                __m128 v = _mm_loadu_ps(data + i + 4 * a);
+                nan = _mm_or_ps(nan, _mm_cmpunord_ps(v, v));
+                acc[a] = better128(acc[a], v);
+            }
+        }
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(data + i);
+            nan = _mm_or_ps(nan, _mm_cmpunord_ps(v, v));
+            acc[0] = better128(acc[0], v);
+        }
+        if (_mm_movemask_ps(nan) != 0)
+            return NONE;
+        float best = reduce128(better128(better128(acc[0], acc[1]), better128(acc[2], acc[3])));
+        for (; i < n; ++i) {
+            if (data[i] != data[i])
+                return NONE;
+            best = better(best, data[i]);
+        }
+
+        const __m128 target = _mm_set1_ps(best);
+        std::size_t j = 0;
+        for (; j + 4 <= n; j += 4) {
+            unsigned mask = unsigned(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + j), target)));
+            if (mask != 0)
+                return j + std::size_t(__builtin_ctz(mask));
+        }
+        return firstOf(data, j, n, best);
+    } // sse41()
+
+    // A NaN beats nothing and nothing beats a NaN bar, as with the scalar
+    // comparison; the ordered predicates give exactly that.
+    [[gnu::target("avx2")]] static std::size_t beatingAvx2(const float *data, std::size_t from,
+                                                           std::size_t n, float bar) {
+        const __m256 target = _mm256_set1_ps(bar);
+        for (; from + 8 <= n; from += 8) {
+            __m256 v = _mm256_loadu_ps(data + from);
+            __m256 gt = MAX ? _mm256_cmp_ps(v, target, _CMP_GT_OQ)
+                            : _mm256_cmp_ps(v, target, _CMP_LT_OQ);
+            unsigned mask = unsigned(_mm256_movemask_ps(gt));
+            if (mask != 0)
+                return from + std::size_t(__builtin_ctz(mask));
+        }
+        return beatingScalar(data, from, n, bar);
+    } // beatingAvx2()
+
+    [[gnu::target("sse4.1")]] static std::size_t beatingSse41(const float *data, std::size_t from,
+                                                              std::size_t n, float bar) {
+        const __m128 target = _mm_set1_ps(bar);
+        for (; from + 4 <= n; from += 4) {
+            __m128 v = _mm_loadu_ps(data + from);
+            __m128 gt = MAX ? _mm_cmpgt_ps(v, target) : _mm_cmplt_ps(v, target);
+            unsigned mask = unsigned(_mm_movemask_ps(gt));
+            if (mask != 0)
+                return from + std::size_t(__builtin_ctz(mask));
+        }
+        return beatingScalar(data, from, n, bar);
+    } // beatingSse41()
+
+private:
+    static float better(float a, float b) {
+        return MAX ? (a < b ? b : a) : (b < a ? b : a);
+    } // better()
+
+    static std::size_t beatingScalar(const float *data, std::size_t from, std::size_t n, float bar) {
+        while (from < n && !(MAX ? bar < data[from] : data[from] < bar))
+            ++from;
+        return from;
+    } // beatingScalar()
+
+    // -0.0f and 0.0f compare equal here, as they do in the scalar loop.
+    static std::size_t firstOf(const float *data, std::size_t from, std::size_t n, float best) {
+        while (from < n && !(data[from] == best))
+            ++from;
+        return from;
+    } // firstOf()
+
+    [[gnu::target("avx2")]] static __m256 better256(__m256 a, __m256 b) {
+        return MAX ? _mm256_max_ps(a, b) : _mm256_min_ps(a, b);
+    } // better256()
+
+    [[gnu::target("sse4.1")]] static __m128 better128(__m128 a, __m128 b) {
+        return MAX ? _mm_max_ps(a, b) : _mm_min_ps(a, b);
+    } // better128()
+
+    [[gnu::target("sse4.1")]] static float reduce128(__m128 v) {
+        v = better128(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = better128(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    } // reduce128()
+}; // SimdExtremeKernels<float>
+
+#endif // SIMDEXTREME_X86
+
+
+// The dispatcher, for comparators whose direction is known.
+template<typename TYPE, bool MAX>
+struct SimdExtremeDispatch {
+    static constexpr bool supported = SimdExtremeKernels<TYPE, MAX>::supported;
+    static constexpr std::size_t NONE = std::size_t(-1);
+    // Below this many elements the scalar loop wins.
+    static constexpr std::size_t MIN_SIMD = 32;
+
+    static std::size_t find(const TYPE *data, std::size_t n) {
+#if SIMDEXTREME_X86
+        using Kernel = std::size_t (*)(const TYPE *, std::size_t);
+        static const Kernel kernel = []() -> Kernel {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return &SimdExtremeKernels<TYPE, MAX>::avx2;
+            if (__builtin_cpu_supports("sse4.1"))
+                return &SimdExtremeKernels<TYPE, MAX>::sse41;
+            return nullptr;
+        }();
+        if (kernel != nullptr && n >= MIN_SIMD)
+            return kernel(data, n);
+#else
+        (void)data;
+        (void)n;
+#endif
+        return NONE;
+    } // find()
+
+    // The first index in [from, n) whose element is strictly more extreme
+    // than 'bar', or n.  Unlike find() this always answers, so a caller can
+    // skip the elements that cannot displace a running candidate at vector
+    // speed and only look at the rest itself.
+    static std::size_t findBeating(const TYPE *data, std::size_t from, std::size_t n, TYPE bar) {
+#if SIMDEXTREME_X86
+        using Kernel = std::size_t (*)(const TYPE *, std::size_t, std::size_t, TYPE);
+        static const Kernel kernel = []() -> Kernel {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return &SimdExtremeKernels<TYPE, MAX>::beatingAvx2;
+            if (__builtin_cpu_supports("sse4.1"))
+                return &SimdExtremeKernels<TYPE, MAX>::beatingSse41;
+            return nullptr;
+        }();
+        if (kernel != nullptr)
+            return kernel(data, from, n, bar);
+#endif
+        while (from < n && !(MAX ? bar < data[from] : data[from] < bar))
+            ++from;
+        return from;
+    } // findBeating()
+}; // SimdExtremeDispatch
+
+
+template<typename TYPE>
+struct SimdExtreme<TYPE, std::less<TYPE>> : SimdExtremeDispatch<TYPE, true> {};
+template<typename TYPE>
+struct SimdExtreme<TYPE, std::greater<TYPE>> : SimdExtremeDispatch<TYPE, false> {};
+
+#endif // SIMDEXTREME_H
@@ -0,0 +1,256 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary snapshots of a queue's contents, for queues of trivially copyable
+// elements.  An image is a SnapshotHeader, the elements as raw bytes in the
+// engine's own order, then extraBytes of engine-specific data:
+//   Heap:    BinaryPQ's heap array, as is.
+//   Sorted:  SortedPQ's sorted array, least extreme first (both layouts).
+//   Pairing: PairingPQ's nodes in preorder of the child/sibling links,
+//            followed by one byte of SnapshotLinks flags per node.
+// restore() maps the image and copies the elements out once, in the order
+// they were written, so nothing is re-heapified or re-sorted.  The image
+// does not record the comparison functor: restoring into a queue with a
+// different order gives a broken queue, which debug builds catch by
+// checking the invariant after every restore.
+//
+// Images are in the byte order and layout of the machine that wrote them;
+// a header from another version, engine or element size is rejected.
+// I/O errors throw std::system_error, a malformed image std::runtime_error.
+enum class SnapshotFormat : std::uint32_t {
+    Heap = 1,
+    Sorted = 2,
+    Pairing = 3
+};
+
+// The per-node flags of a Pairing image.
+enum SnapshotLinks : std::uint8_t {
+    SNAPSHOT_HAS_CHILD = 1,
+    SNAPSHOT_HAS_SIBLING = 2
+};
+
+// 64 bytes, so the elements that follow it are aligned for any TYPE with
+// alignof(TYPE) <= 64 in a page-aligned mapping.
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t eltSize;
+    std::uint64_t count;
+    std::uint64_t extraBytes;
+    char reserved[24];
+};
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must stay 64 bytes");
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'P', 'Q', 'S', 'N', 'A', 'P', '\0', '\0' };
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+
+// Writes one image.  The bytes go to path + ".partial", which finish()
+// renames to path, so a failed or abandoned snapshot never replaces an
+// existing image.
+class SnapshotWriter {
+public:
+    // Description: Start an image of 'count' elements of 'eltSize' bytes,
+    //              followed by 'extraBytes' of engine data.
+    SnapshotWriter(const std::string &path, SnapshotFormat format, std::size_t eltSize,
+                   std::uint64_t count, std::uint64_t extraBytes = 0) :
+        finalPath{ path }, partialPath{ path + ".partial" } {
+        file = std::fopen(partialPath.c_str(), "wb");
+        if (file == nullptr)
+            fail("cannot create");
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.format = static_cast<std::uint32_t>(format);
+        header.eltSize = eltSize;
+        header.count = count;
+        header.extraBytes = extraBytes;
+        // The destructor does not run for a constructor that throws.
+        try {
+            write(&header, sizeof(header));
+        }
+        catch (...) {
+            std::fclose(file);
+            std::remove(partialPath.c_str());
+            throw;
+        }
+    } // SnapshotWriter()
+
+
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+
+    // Description: Drop an unfinished image.
+    ~SnapshotWriter() {
+        if (file != nullptr) {
+            std::fclose(file);
+            std::remove(partialPath.c_str());
+        }
+    } // ~SnapshotWriter()
+
+
+    // Description: Append 'size' bytes.
+    void write(const void *bytes, std::size_t size) {
+        if (size != 0 && std::fwrite(bytes, 1, size, file) != size)
+            fail("cannot write");
+    } // write()
+
+
+    // Description: Close the image and move it into place.
+    void finish() {
+        std::FILE *closing = file;
+        file = nullptr;
+        if (std::fclose(closing) != 0) {
+            int err = errno;
+            std::remove(partialPath.c_str());
+            errno = err;
+            fail("cannot write");
+        }
+        if (std::rename(partialPath.c_str(), finalPath.c_str()) != 0) {
+            int err = errno;
+            std::remove(partialPath.c_str());
+            errno = err;
+            fail("cannot rename");
+        }
+    } // finish()
+
+
+private:
+    std::string finalPath;
+    std::string partialPath;
+    std::FILE *file = nullptr;
+
+    [[noreturn]] void fail(const char *what) const {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("snapshot: ") + what + " " + partialPath);
+    } // fail()
+}; // SnapshotWriter
+
+
+// A read-only mapping of one image, checked against the format and element
+// size the restoring engine expects.
+class SnapshotImage {
+public:
+    // Description: Map the image at 'path'.
+    SnapshotImage(const std::string &path, SnapshotFormat format, std::size_t eltSize) :
+        path{ path } {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            fail("cannot open");
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int err = errno;
+            close(fd);
+            errno = err;
+            fail("cannot stat");
+        }
+        length = std::size_t(st.st_size);
+        if (length < sizeof(SnapshotHeader)) {
+            close(fd);
+            malformed("is too short");
+        }
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        int err = errno;
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            errno = err;
+            fail("cannot map");
+        }
+        base = static_cast<const unsigned char *>(mapped);
+        // The elements are read front to back, once.
+        madvise(mapped, length, MADV_SEQUENTIAL);
+
+        const SnapshotHeader &header = *reinterpret_cast<const SnapshotHeader *>(base);
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SNAPSHOT_VERSION) {
+            unmap();
+            malformed("is not a snapshot of this version");
+        }
+        if (header.format != static_cast<std::uint32_t>(format) || header.eltSize != eltSize) {
+            unmap();
+            malformed("is of another engine or element type");
+        }
+        const std::uint64_t room = length - sizeof(SnapshotHeader);
+        if (header.count > room / eltSize || header.extraBytes != room - header.count * eltSize) {
+            unmap();
+            malformed("has the wrong length");
+        }
+        numElements = header.count;
+        numExtra = header.extraBytes;
+    } // SnapshotImage()
+
+
+    SnapshotImage(const SnapshotImage &) = delete;
+    SnapshotImage &operator=(const SnapshotImage &) = delete;
+
+
+    ~SnapshotImage() {
+        unmap();
+    } // ~SnapshotImage()
+
+
+    // Description: The number of elements in the image.
+    std::size_t count() const {
+        return std::size_t(numElements);
+    } // count()
+
+
+    // Description: The elements, in the order they were written.
+    template<typename TYPE>
+    const TYPE *elements() const {
+        return reinterpret_cast<const TYPE *>(base + sizeof(SnapshotHeader));
+    } // elements()
+
+
+    // Description: The engine data after the elements, and its length.
+    const unsigned char *extra() const {
+        return base + (length - numExtra);
+    } // extra()
+
+    std::size_t extraBytes() const {
+        return std::size_t(numExtra);
+    } // extraBytes()
+
+
+    // Description: Throw std::runtime_error naming this image.
+    [[noreturn]] void malformed(const char *what) const {
+        throw std::runtime_error("snapshot: " + path + " " + what);
+    } // malformed()
+
+
+private:
+    std::string path;
+    const unsigned char *base = nullptr;
+    std::size_t length = 0;
+    std::uint64_t numElements = 0;
+    std::uint64_t numExtra = 0;
+
+    void unmap() {
+        if (base != nullptr)
+            munmap(const_cast<unsigned char *>(base), length);
+        base = nullptr;
+    } // unmap()
+
+    [[noreturn]] void fail(const char *what) const {
+        throw std::system_error(errno, std::generic_category(), "snapshot: " + std::string(what) + " " + path);
+    } // fail()
+}; // SnapshotImage
+
+#endif // SNAPSHOT_H
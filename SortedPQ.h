@@ -3,19 +3,48 @@
 #ifndef SORTEDPQ_H
 #define SORTEDPQ_H
 
-#include "Eecs281PQ.h"
+#include "DirtySet.h"
+#include "Eecs281StaticPQ.h"
+#include "Snapshot.h"
 #include <algorithm>
+#include <cassert>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Storage layouts for SortedPQ.
+//   FlatSorted:    one sorted vector.  push() shifts every less extreme
+//                  element up one slot, so it is O(n) moves.
+//   BlockedSorted: a sequence of sorted blocks of about BLOCK_BYTES each, so
+//                  push() shifts elements within one block only.  A block
+//                  splits in two when it doubles; the most extreme element is
+//                  still the last one of the last block.
+struct FlatSorted {};
+template<std::size_t BLOCK_BYTES = 4096>
+struct BlockedSorted {};
+
 
 // A specialized version of the 'heap' ADT that is implemented with an
 // underlying sorted array-based container.
 // Note: The most extreme element should be found at the end of the
 // 'data' container, such that traversing the iterators yields the elements in
 // sorted order.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// LAYOUT is FlatSorted (this template) or BlockedSorted (the partial
+// specialization below).  STATS is a statistics policy from PQStats.h.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename LAYOUT = FlatSorted, typename STATS = NoStats>
+class SortedPQ final
+    : public Eecs281StaticPQ<SortedPQ<TYPE, COMP_FUNCTOR, LAYOUT, STATS>, TYPE, COMP_FUNCTOR, STATS> {
+    static_assert(std::is_same<LAYOUT, FlatSorted>::value,
+                  "SortedPQ layouts are FlatSorted and BlockedSorted<BLOCK_BYTES>");
+
     // This is a way to refer to the base class object.
-    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+    using BaseClass = Eecs281StaticPQ<SortedPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
 
 public:
     // Description: Construct an empty heap with an optional comparison functor.
@@ -45,15 +74,20 @@ public:
 
     // Description: Add a new element to the heap.
     // Runtime: O(n)
-    // TODO: When you implement this function, uncomment the parameter names.
     virtual void push(const TYPE &val) {
-        data.resize(data.size() + 1);
-        auto it = lower_bound(data.begin(), data.begin() + data.size() - 1, val, this->compare);
-        for (auto i = data.begin() + data.size() - 2; i >= it; --i) {
-            *(i + 1) = *i;
-        }
-        *it = val;
-        // TODO: Implement this function
+        auto it = std::lower_bound(data.begin(), data.end(), val, this->countedComparator());
+        this->stats().onMove(std::size_t(data.end() - it));
+        data.insert(it, val);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.  The larger
+    //              elements are moved (not copied) up one slot to make room.
+    // Runtime: O(n)
+    virtual void push(TYPE &&val) {
+        auto it = std::lower_bound(data.begin(), data.end(), val, this->countedComparator());
+        this->stats().onMove(std::size_t(data.end() - it));
+        data.insert(it, std::move(val));
     } // push()
 
 
@@ -68,6 +102,30 @@ public:
     } // pop()
 
 
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the back of the vector.
+    // Runtime: Amortized O(1)
+    virtual TYPE pop_value() {
+        TYPE val = std::move(data.back());
+        data.pop_back();
+        return val;
+    } // pop_value()
+
+
+    // Description: Move every element of 'other' into this heap and leave
+    //              'other' empty.  Both vectors are already sorted, so this is
+    //              a single linear merge.  Both heaps must use equivalent
+    //              comparison functors.
+    // Runtime: O(n + m) for m elements in other.
+    void merge(SortedPQ &&other) {
+        if (&other == this)
+            return;
+        mergeSorted(other.data);
+        other.data.clear();
+        dirty.merge(other.dirty);
+    } // merge()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
@@ -102,17 +160,426 @@ public:
     //              'rebuilds' the heap by fixing the heap invariant.
     // Runtime: O(n log n)
     virtual void updatePriorities() {
-        std::sort(data.begin(), data.end(), this->compare);
+        dirty.clear();
+        std::sort(data.begin(), data.end(), this->countedComparator());
         // TODO: Implement this function
     } // updatePriorities()
 
 
+    // Description: Record that the priority of 'val', an element in the heap,
+    //              has changed (for instance, the value a pointer element
+    //              points to).  Nothing moves until updateDirty().  The
+    //              element is found again by identity (see DirtySet.h), so
+    //              TYPE is usually a pointer or an index.
+    // Runtime: O(1)
+    void markDirty(const TYPE &val) {
+        dirty.add(val);
+    } // markDirty()
+
+
+    // Description: Re-sort after the priorities of the elements given to
+    //              markDirty() changed.  One pass moves them out, leaving the
+    //              rest in order; they are sorted on their own and merged back.
+    //              Past 1 / DIRTY_REBUILD of the heap, updatePriorities() is
+    //              used instead.
+    // Runtime: O(n + d log(d)) for d dirty elements.
+    void updateDirty() {
+        if (dirty.empty())
+            return;
+        if (dirty.size() * DIRTY_REBUILD > size()) {
+            updatePriorities();
+            return;
+        }
+        dirty.prepare();
+        std::vector<TYPE> moved;
+        auto keep = data.begin();
+        for (auto it = data.begin(); it != data.end(); ++it) {
+            if (dirty.contains(*it))
+                moved.push_back(std::move(*it));
+            else {
+                // Skip the self-move while nothing has been taken out yet.
+                if (keep != it)
+                    *keep = std::move(*it);
+                ++keep;
+            }
+        } // for
+        data.erase(keep, data.end());
+        dirty.clear();
+        std::sort(moved.begin(), moved.end(), this->countedComparator());
+        mergeSorted(moved);
+    } // updateDirty()
+
+
+    // Description: Write the sorted array as is to a Sorted image at 'path'
+    //              (see Snapshot.h).  TYPE must be trivially copyable.
+    // Runtime: O(n)
+    void snapshot(const std::string &path) const {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots write elements as raw bytes");
+        SnapshotWriter out{ path, SnapshotFormat::Sorted, sizeof(TYPE), size() };
+        out.write(data.data(), size() * sizeof(TYPE));
+        out.finish();
+    } // snapshot()
+
+
+    // Description: Replace the contents with the Sorted image at 'path',
+    //              written by either layout, without sorting it again.  The
+    //              image must come from a heap with the same order; debug
+    //              builds check that it is sorted.
+    // Runtime: O(n), one copy out of the mapped image.
+    void restore(const std::string &path) {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots read elements as raw bytes");
+        static_assert(alignof(TYPE) <= sizeof(SnapshotHeader), "snapshot elements follow the header");
+        SnapshotImage image{ path, SnapshotFormat::Sorted, sizeof(TYPE) };
+        if (image.extraBytes() != 0)
+            image.malformed("has trailing data");
+        const TYPE *elts = image.elements<TYPE>();
+        data.assign(elts, elts + image.count());
+        dirty.clear();
+        this->stats().onMove(data.size());
+        assert(std::is_sorted(data.begin(), data.end(), this->compare) && "snapshot is not sorted in this order");
+    } // restore()
+
+
+protected:
+    // Description: Sort the batch on its own, then merge it with the
+    //              existing data instead of shifting the tail once per element.
+    // Runtime: O(k log(k) + n) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        std::sort(batch.begin(), batch.end(), this->countedComparator());
+        mergeSorted(batch);
+    } // pushBatch()
+
+
+    // Description: The k most extreme elements are the last k in the vector;
+    //              move them out back to front and cut the tail off at once.
+    // Runtime: O(k)
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        batch.insert(batch.end(), std::make_move_iterator(data.rbegin()),
+                     std::make_move_iterator(data.rbegin() + std::ptrdiff_t(k)));
+        data.erase(data.end() - std::ptrdiff_t(k), data.end());
+    } // popBatch()
+
+
 private:
     // Note: This vector *must* be used for your heap implementation.
     std::vector<TYPE> data;
 
     // TODO: Add any additional member functions or data you require here.
 
+    // Elements given to markDirty() since the last repair.
+    DirtySet<TYPE> dirty;
+    // updateDirty() re-sorts everything once more than 1 / DIRTY_REBUILD of
+    // the heap is dirty; below that the merge beats an O(n log n) sort.
+    static constexpr std::size_t DIRTY_REBUILD = 8;
+
+    // Move the already sorted 'sorted' into data, keeping data sorted.
+    void mergeSorted(std::vector<TYPE> &sorted) {
+        if (data.empty()) {
+            data.swap(sorted);
+            return;
+        }
+        const std::size_t oldSize = data.size();
+        data.insert(data.end(), std::make_move_iterator(sorted.begin()),
+                    std::make_move_iterator(sorted.end()));
+        std::inplace_merge(data.begin(), data.begin() + std::ptrdiff_t(oldSize), data.end(),
+                           this->countedComparator());
+        this->stats().onMove(data.size());
+    } // mergeSorted()
+
+}; // SortedPQ
+
+
+// The blocked layout.  Blocks hold between one and 2 * BLOCK - 1 elements,
+// each sorted, and every element of a block is at most as extreme as every
+// element of the next.  push() binary searches the blocks by their last
+// (most extreme) elements, then inserts into one block; top() and pop() work
+// on the last block.
+template<typename TYPE, typename COMP_FUNCTOR, std::size_t BLOCK_BYTES, typename STATS>
+class SortedPQ<TYPE, COMP_FUNCTOR, BlockedSorted<BLOCK_BYTES>, STATS> final
+    : public Eecs281StaticPQ<SortedPQ<TYPE, COMP_FUNCTOR, BlockedSorted<BLOCK_BYTES>, STATS>,
+                             TYPE, COMP_FUNCTOR, STATS> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281StaticPQ<SortedPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
+
+public:
+    // Elements per block after a split or a rebuild.
+    static constexpr std::size_t BLOCK = std::max<std::size_t>(16, BLOCK_BYTES / sizeof(TYPE));
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // SortedPQ()
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n log n) where n is number of elements in range.
+    template<typename InputIterator>
+    SortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+        std::vector<TYPE> all(start, end);
+        std::sort(all.begin(), all.end(), this->countedComparator());
+        rebuild(all);
+    } // SortedPQ()
+
+
+    // Description: Destructor doesn't need any code, the blocks will be
+    //              destroyed automatically.
+    virtual ~SortedPQ() {
+    } // ~SortedPQ()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n) + BLOCK)
+    virtual void push(const TYPE &val) {
+        insert(val);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: O(log(n) + BLOCK)
+    virtual void push(TYPE &&val) {
+        insert(std::move(val));
+    } // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap, dropping the last block once it is empty.
+    // Runtime: O(1)
+    virtual void pop() {
+        blocks.back().pop_back();
+        if (blocks.back().empty())
+            blocks.pop_back();
+        --numElements;
+    } // pop()
+
+
+    // Description: Remove the most extreme element and return it.
+    // Runtime: O(1)
+    virtual TYPE pop_value() {
+        TYPE val = std::move(blocks.back().back());
+        pop();
+        return val;
+    } // pop_value()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return blocks.back().back();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return numElements;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return numElements == 0;
+    } // empty()
+
+
+    // Description: Move every element of 'other' into this heap and leave
+    //              'other' empty.  Both heaps must use equivalent comparison
+    //              functors.
+    // Runtime: O(n + m) for m elements in other.
+    void merge(SortedPQ &&other) {
+        if (&other == this)
+            return;
+        std::vector<TYPE> sorted = other.flatten();
+        insertSorted(sorted);
+        dirty.merge(other.dirty);
+    } // merge()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by sorting everything into new blocks.
+    // Runtime: O(n log n)
+    virtual void updatePriorities() {
+        dirty.clear();
+        std::vector<TYPE> all = flatten();
+        std::sort(all.begin(), all.end(), this->countedComparator());
+        rebuild(all);
+    } // updatePriorities()
+
+
+    // Description: As FlatSorted's markDirty().
+    // Runtime: O(1)
+    void markDirty(const TYPE &val) {
+        dirty.add(val);
+    } // markDirty()
+
+
+    // Description: Take the elements given to markDirty() out of their
+    //              blocks, sort them on their own and put them back as
+    //              push_range() does.  Past 1 / DIRTY_REBUILD of the heap,
+    //              updatePriorities() is used instead.
+    // Runtime: O(n + d log(d) + min(d BLOCK, n)) for d dirty elements.
+    void updateDirty() {
+        if (dirty.empty())
+            return;
+        if (dirty.size() * DIRTY_REBUILD > size()) {
+            updatePriorities();
+            return;
+        }
+        dirty.prepare();
+        std::vector<TYPE> moved;
+        for (std::vector<TYPE> &block : blocks) {
+            auto keep = block.begin();
+            for (auto it = block.begin(); it != block.end(); ++it) {
+                if (dirty.contains(*it))
+                    moved.push_back(std::move(*it));
+                else {
+                    if (keep != it)
+                        *keep = std::move(*it);
+                    ++keep;
+                }
+            } // for
+            block.erase(keep, block.end());
+        } // for
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                    [](const std::vector<TYPE> &block) { return block.empty(); }),
+                     blocks.end());
+        numElements -= moved.size();
+        dirty.clear();
+        std::sort(moved.begin(), moved.end(), this->countedComparator());
+        insertSorted(moved);
+    } // updateDirty()
+
+
+    // Description: Write the blocks, in order, to a Sorted image at 'path'
+    //              (see Snapshot.h); it is the same image FlatSorted writes.
+    //              TYPE must be trivially copyable.
+    // Runtime: O(n)
+    void snapshot(const std::string &path) const {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots write elements as raw bytes");
+        SnapshotWriter out{ path, SnapshotFormat::Sorted, sizeof(TYPE), size() };
+        for (const std::vector<TYPE> &block : blocks)
+            out.write(block.data(), block.size() * sizeof(TYPE));
+        out.finish();
+    } // snapshot()
+
+
+    // Description: Replace the contents with the Sorted image at 'path',
+    //              written by either layout, cutting it into blocks of BLOCK
+    //              elements without sorting it again.  The image must come
+    //              from a heap with the same order; debug builds check that
+    //              it is sorted.
+    // Runtime: O(n), one copy out of the mapped image.
+    void restore(const std::string &path) {
+        static_assert(std::is_trivially_copyable<TYPE>::value, "snapshots read elements as raw bytes");
+        static_assert(alignof(TYPE) <= sizeof(SnapshotHeader), "snapshot elements follow the header");
+        SnapshotImage image{ path, SnapshotFormat::Sorted, sizeof(TYPE) };
+        if (image.extraBytes() != 0)
+            image.malformed("has trailing data");
+        const TYPE *elts = image.elements<TYPE>();
+        const std::size_t count = image.count();
+        assert(std::is_sorted(elts, elts + count, this->compare) && "snapshot is not sorted in this order");
+        blocks.clear();
+        dirty.clear();
+        for (std::size_t start = 0; start < count; start += BLOCK)
+            blocks.emplace_back(elts + start, elts + std::min(count, start + BLOCK));
+        numElements = count;
+        this->stats().onMove(count);
+    } // restore()
+
+
+protected:
+    // Description: Sort the batch on its own, then insert it element by
+    //              element or merge it with everything, whichever moves less.
+    // Runtime: O(k log(k) + min(k BLOCK, n + k)) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        std::sort(batch.begin(), batch.end(), this->countedComparator());
+        insertSorted(batch);
+    } // pushBatch()
+
+
+private:
+    // Sorted blocks, least extreme first; none is empty.
+    std::vector<std::vector<TYPE>> blocks;
+    std::size_t numElements = 0;
+    // Elements given to markDirty() since the last repair.
+    DirtySet<TYPE> dirty;
+    // As for FlatSorted.
+    static constexpr std::size_t DIRTY_REBUILD = 8;
+
+    template<typename VALUE>
+    void insert(VALUE &&val) {
+        if (blocks.empty())
+            blocks.emplace_back();
+        // The first block whose last element is not less extreme than val;
+        // the last block if there is none.
+        auto blockIt = std::lower_bound(blocks.begin(), blocks.end() - 1, val,
+                                        [this](const std::vector<TYPE> &block, const TYPE &v) {
+                                            return this->countedCompare(block.back(), v);
+                                        });
+        std::vector<TYPE> &block = *blockIt;
+        auto it = std::lower_bound(block.begin(), block.end(), val, this->countedComparator());
+        this->stats().onMove(std::size_t(block.end() - it));
+        block.insert(it, std::forward<VALUE>(val));
+        ++numElements;
+        if (block.size() >= 2 * BLOCK)
+            split(blockIt);
+    } // insert()
+
+    // Move the upper half of a full block into a new block after it.
+    void split(typename std::vector<std::vector<TYPE>>::iterator blockIt) {
+        std::vector<TYPE> upper(std::make_move_iterator(blockIt->begin() + std::ptrdiff_t(BLOCK)),
+                                std::make_move_iterator(blockIt->end()));
+        blockIt->erase(blockIt->begin() + std::ptrdiff_t(BLOCK), blockIt->end());
+        this->stats().onMove(upper.size());
+        blocks.insert(blockIt + 1, std::move(upper));
+    } // split()
+
+    // Move every element out, in order, leaving the heap empty.
+    std::vector<TYPE> flatten() {
+        std::vector<TYPE> all;
+        all.reserve(numElements);
+        for (std::vector<TYPE> &block : blocks)
+            all.insert(all.end(), std::make_move_iterator(block.begin()),
+                       std::make_move_iterator(block.end()));
+        this->stats().onMove(all.size());
+        blocks.clear();
+        numElements = 0;
+        return all;
+    } // flatten()
+
+    // Cut a sorted vector into blocks of BLOCK elements; the heap must be empty.
+    void rebuild(std::vector<TYPE> &sorted) {
+        for (std::size_t start = 0; start < sorted.size(); start += BLOCK) {
+            const std::size_t stop = std::min(sorted.size(), start + BLOCK);
+            blocks.emplace_back(std::make_move_iterator(sorted.begin() + std::ptrdiff_t(start)),
+                                std::make_move_iterator(sorted.begin() + std::ptrdiff_t(stop)));
+        }
+        this->stats().onMove(sorted.size());
+        numElements = sorted.size();
+    } // rebuild()
+
+    // Add the already sorted 'sorted': one insert() per element while that
+    // moves less than merging everything and cutting new blocks.
+    void insertSorted(std::vector<TYPE> &sorted) {
+        if (sorted.size() * BLOCK < size()) {
+            for (TYPE &val : sorted)
+                insert(std::move(val));
+            return;
+        }
+        std::vector<TYPE> all = flatten();
+        const std::size_t oldSize = all.size();
+        all.insert(all.end(), std::make_move_iterator(sorted.begin()),
+                   std::make_move_iterator(sorted.end()));
+        std::inplace_merge(all.begin(), all.begin() + std::ptrdiff_t(oldSize), all.end(),
+                           this->countedComparator());
+        rebuild(all);
+    } // insertSorted()
 }; // SortedPQ
 
 #endif // SORTEDPQ_H
@@ -3,11 +3,13 @@
 #ifndef UNORDEREDFASTPQ_H
 #define UNORDEREDFASTPQ_H
 
-#include "Eecs281PQ.h"
+#include "Eecs281StaticPQ.h"
+#include "SimdExtreme.h"
 
-#include <limits>  // needed for UNKNOWN
-
-static const size_t UNKNOWN = std::numeric_limits<size_t>::max();
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <utility>
 
 
 // A specialized version of the 'heap' ADT that is implemented with an
@@ -17,21 +19,37 @@ static const size_t UNKNOWN = std::numeric_limits<size_t>::max();
 // Since top() is almost always followed by pop(), when top() has to find
 // the most extreme element, it remembers that index so that pop() does
 // does not have to search again.  Note the use of the mutable variable.
+//
+// The search remembers more than one index: the CACHE most extreme
+// elements, in order, so a run of up to CACHE pops costs one scan instead of
+// one each.  Every element outside the cache is at most as extreme as the
+// least extreme cached one, so a push that beats that one joins the cache
+// (pushing the least extreme out if it is full) and any other push leaves it
+// valid.  Only an empty cache means a rescan.  With CACHE = 1 this is the
+// single remembered index.
 
 // TODO: Read and understand this priority queue implementation!
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// STATS is a statistics policy from PQStats.h.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t CACHE = 16,
+         typename STATS = NoStats>
+class UnorderedFastPQ final
+    : public Eecs281StaticPQ<UnorderedFastPQ<TYPE, COMP_FUNCTOR, CACHE, STATS>, TYPE, COMP_FUNCTOR,
+                             STATS> {
+    static_assert(CACHE >= 1, "UnorderedFastPQ needs room for at least one index");
+
     // This is a way to refer to the base class object.
-    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+    using BaseClass = Eecs281StaticPQ<UnorderedFastPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
 
 public:
     // Description: Construct an empty heap with an optional comparison functor.
     // Runtime: O(1)
     explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, extreme{ UNKNOWN } {
+        BaseClass{ comp } {
     } // UnorderedFastPQ()
 
 
@@ -40,7 +58,7 @@ public:
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
     UnorderedFastPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, data{ start, end }, extreme{ UNKNOWN } {
+        BaseClass{ comp }, data{ start, end } {
     } // UnorderedFastPQ()
 
 
@@ -51,24 +69,40 @@ public:
 
 
     // Description: The only thing needed is to mark that we no longer know the
-    //              most extreme element.
+    //              most extreme elements.
     // Runtime: O(1)
     virtual void updatePriorities() {
-        extreme = UNKNOWN;
+        numCached = 0;
     } // updatePriorities()
 
 
     // Description: Add a new element to the heap.
-    // Runtime: Amortized O(1)
+    // Runtime: Amortized O(1), O(CACHE) if it joins the cache.
     virtual void push(const TYPE &val) {
         data.push_back(val);
 
-        // Since a new element has been added, we no longer know where to find
-        // the most extreme element.
-        extreme = UNKNOWN;
+        // The new element may be more extreme than some we remembered.
+        admit(data.size() - 1);
+    } // push()
+
+
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: Amortized O(1), O(CACHE) if it joins the cache.
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        admit(data.size() - 1);
     } // push()
 
 
+    // Description: Construct a new element in place at the back of the vector.
+    // Runtime: Amortized O(1), O(CACHE) if it joins the cache.
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        admit(data.size() - 1);
+    } // emplace()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
@@ -76,24 +110,42 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: O(n)
     // Note: If the most extreme element is already known (as would happen if
-    //       .top() was called before .pop()), this function is O(1).
+    //       .top() was called before .pop(), or up to CACHE pops after one
+    //       search), this function is O(CACHE).
     virtual void pop() {
         // If we don't already know the index of the most extreme element, find it.
-        if (extreme == UNKNOWN)
+        if (numCached == 0)
             findExtreme();
+        const size_t extreme = cached[--numCached];
 
         // Replace the most extreme element with the element at the back, then
         // pop_back().  This is much faster than erasing from the middle of a
-        // vector.
-        data[extreme] = data.back();
+        // vector.  The cache has to follow the element that moved.
+        const size_t last = data.size() - 1;
+        if (extreme != last) {
+            data[extreme] = std::move(data.back());
+            this->stats().onMove();
+            for (size_t i = 0; i < numCached; ++i) {
+                if (cached[i] == last)
+                    cached[i] = extreme;
+            }
+        }
         data.pop_back();
-
-        // Since the most extreme element has been removed, we no longer know
-        // where to find it.
-        extreme = UNKNOWN;
     } // pop()
 
 
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the vector.
+    // Runtime: O(n), or O(CACHE) if the most extreme element is already known.
+    virtual TYPE pop_value() {
+        if (numCached == 0)
+            findExtreme();
+        TYPE val = std::move(data[cached[numCached - 1]]);
+        pop();
+        return val;
+    } // pop_value()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
@@ -101,11 +153,11 @@ public:
     // Runtime: O(n)
     virtual const TYPE &top() const {
         // If we don't already know the index of the most extreme element, find it.
-        if (extreme == UNKNOWN)
+        if (numCached == 0)
             findExtreme();
 
         // Return the most extreme element by const reference.
-        return data[extreme];
+        return data[cached[numCached - 1]];
     } // top()
 
 
@@ -122,28 +174,110 @@ public:
     } // empty()
 
 
+protected:
+    // Description: Append the whole batch; there is no order to maintain.
+    // Runtime: O(k) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        data.insert(data.end(), std::make_move_iterator(batch.begin()),
+                    std::make_move_iterator(batch.end()));
+        numCached = 0;
+    } // pushBatch()
+
+
+    // Description: One selection pass moves the k most extreme elements to the
+    //              back of the vector; only those k are then sorted and moved
+    //              out, instead of k separate linear scans.
+    // Runtime: O(n + k log(k))
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        if (k == 0)
+            return;
+        if (k == 1) {
+            batch.push_back(pop_value());
+            return;
+        }
+        auto tail = data.end() - std::ptrdiff_t(k);
+        std::nth_element(data.begin(), tail, data.end(), this->countedComparator());
+        std::sort(tail, data.end(), this->countedComparator());
+        batch.insert(batch.end(), std::make_move_iterator(data.rbegin()),
+                     std::make_move_iterator(data.rbegin() + std::ptrdiff_t(k)));
+        data.erase(tail, data.end());
+        numCached = 0;
+    } // popBatch()
+
+
 private:
     // Note: This vector *must* be used for your heap implementation.
     std::vector<TYPE> data;
 
 private:
-    // A member variable that can be changed by a const member function;
-    // stores the index of the most extreme element, or UNKNOWN.
-    mutable size_t extreme;
+    // Member variables that can be changed by a const member function: the
+    // indices of the most extreme elements, least extreme first, in
+    // cached[0 .. numCached).  numCached == 0 means they are not known.
+    mutable std::array<size_t, CACHE> cached;
+    mutable size_t numCached = 0;
 
-    // Description: Find the 'most extreme' element of the data vector, using
+    // Description: Find the 'most extreme' elements of the data vector, using
     //              this->compare() to check if one element is 'less than'
-    //              another.
-    // Runtime: O(n)
+    //              another.  One pass keeps the best CACHE seen so far;
+    //              an element has to beat the least extreme of them to get in.
+    //              For int or float under std::less or std::greater and with
+    //              no statistics to report, the search is vectorized (see
+    //              SimdExtreme.h): with CACHE = 1 it is one find(), and
+    //              otherwise findBeating() skips the elements that cannot
+    //              get in.
+    // Runtime: O(n), plus O(CACHE) for each element that gets in.
     void findExtreme() const {
-        size_t index = 0;
-
-        for (size_t i = 1; i < data.size(); ++i)
-            if (this->compare(data[index], data[i]))
-                index = i;
-
-        extreme = index;
+        using Simd = SimdExtreme<TYPE, COMP_FUNCTOR>;
+        if constexpr (CACHE == 1 && !STATS::enabled && Simd::supported) {
+            size_t index = Simd::find(data.data(), data.size());
+            if (index != Simd::NONE) {
+                cached[0] = index;
+                numCached = 1;
+                return;
+            }
+        }
+        numCached = 0;
+        size_t i = 0;
+        for (; i < data.size() && numCached < CACHE; ++i)
+            insertCached(i);
+        if constexpr (CACHE > 1 && !STATS::enabled && Simd::supported) {
+            for (i = Simd::findBeating(data.data(), i, data.size(), data[cached[0]]); i < data.size();
+                 i = Simd::findBeating(data.data(), i + 1, data.size(), data[cached[0]]))
+                insertCached(i);
+            return;
+        }
+        for (; i < data.size(); ++i) {
+            if (this->countedCompare(data[cached[0]], data[i]))
+                insertCached(i);
+        }
     } // findExtreme()
+
+    // Add the element at 'index' to the cache if it is known and the element
+    // beats the least extreme cached one.
+    void admit(size_t index) {
+        if (numCached != 0 && this->countedCompare(data[cached[0]], data[index]))
+            insertCached(index);
+    } // admit()
+
+    // Insert 'index' in order, dropping the least extreme index if full.
+    void insertCached(size_t index) const {
+        size_t pos = 0;
+        if (numCached == CACHE) {
+            // Slide the lower entries down over the dropped one.
+            while (pos + 1 < numCached && !this->countedCompare(data[index], data[cached[pos + 1]])) {
+                cached[pos] = cached[pos + 1];
+                ++pos;
+            }
+        }
+        else {
+            pos = numCached++;
+            while (pos > 0 && this->countedCompare(data[index], data[cached[pos - 1]])) {
+                cached[pos] = cached[pos - 1];
+                --pos;
+            }
+        }
+        cached[pos] = index;
+    } // insertCached()
 }; // UnorderedFastPQ
 
 #endif // UNORDEREDFASTPQ_H
@@ -4,7 +4,11 @@
 #ifndef UNORDEREDPQ_H
 #define UNORDEREDPQ_H
 
-#include "Eecs281PQ.h"
+#include "Eecs281StaticPQ.h"
+#include "SimdExtreme.h"
+
+#include <iterator>
+#include <utility>
 
 
 // A specialized version of the 'heap' ADT that is implemented with an
@@ -15,10 +19,14 @@
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class UnorderedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// STATS is a statistics policy from PQStats.h.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename STATS = NoStats>
+class UnorderedPQ final
+    : public Eecs281StaticPQ<UnorderedPQ<TYPE, COMP_FUNCTOR, STATS>, TYPE, COMP_FUNCTOR, STATS> {
     // This is a way to refer to the base class object.
-    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+    using BaseClass = Eecs281StaticPQ<UnorderedPQ, TYPE, COMP_FUNCTOR, STATS>;
+    // Lets the static interface reach the protected batch hooks.
+    friend BaseClass;
 
 public:
     // Description: Construct an empty heap with an optional comparison functor.
@@ -57,6 +65,21 @@ public:
     } // push()
 
 
+    // Description: Add a new element to the heap, moving it in.
+    // Runtime: Amortized O(1)
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+    } // push()
+
+
+    // Description: Construct a new element in place at the back of the vector.
+    // Runtime: Amortized O(1)
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+    } // emplace()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
@@ -69,11 +92,21 @@ public:
         // Replace the most extreme element with the element at the back, then
         // pop_back().  This is much faster than erasing from the middle of a
         // vector.
-        data[findExtreme()] = data.back();
-        data.pop_back();
+        removeAt(findExtreme());
     } // pop()
 
 
+    // Description: Remove the most extreme element and return it by moving it
+    //              out of the vector.
+    // Runtime: O(n)
+    virtual TYPE pop_value() {
+        size_t index = findExtreme();
+        TYPE val = std::move(data[index]);
+        removeAt(index);
+        return val;
+    } // pop_value()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
@@ -98,20 +131,47 @@ public:
     } // empty()
 
 
+protected:
+    // Description: Append the whole batch; there is no order to maintain.
+    // Runtime: O(k) for a batch of k elements.
+    virtual void pushBatch(std::vector<TYPE> &batch) {
+        data.insert(data.end(), std::make_move_iterator(batch.begin()),
+                    std::make_move_iterator(batch.end()));
+    } // pushBatch()
+
+
 private:
     // Note: This vector *must* be used for your heap implementation.
     std::vector<TYPE> data;
 
 private:
+    // Description: Fill the hole at 'index' with the last element (unless it
+    //              is the last element) and shrink the vector by one.
+    // Runtime: O(1)
+    void removeAt(size_t index) {
+        if (index + 1 != data.size()) {
+            data[index] = std::move(data.back());
+            this->stats().onMove();
+        }
+        data.pop_back();
+    } // removeAt()
+
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
-    //              another.
+    //              another.  For int or float under std::less or std::greater,
+    //              with no statistics to report, the search is vectorized
+    //              (see SimdExtreme.h).
     // Runtime: O(n)
     size_t findExtreme() const {
+        if constexpr (!STATS::enabled && SimdExtreme<TYPE, COMP_FUNCTOR>::supported) {
+            size_t index = SimdExtreme<TYPE, COMP_FUNCTOR>::find(data.data(), data.size());
+            if (index != SimdExtreme<TYPE, COMP_FUNCTOR>::NONE)
+                return index;
+        }
         size_t index = 0;
 
         for (size_t i = 1; i < data.size(); ++i)
-            if (this->compare(data[index], data[i]))
+            if (this->countedCompare(data[index], data[i]))
                 index = i;
 
         return index;
@@ -0,0 +1,165 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+/*
+ * Multi-threaded throughput of the concurrent MultiQueuePQ against a single
+ * engine behind one global mutex.  Built and run by 'make bench' together
+ * with benchPQ; pass arguments with 'make bench benchConcurrent_ARGS="..."'.
+ *
+ *     benchConcurrent [maxN [engine]]
+ *
+ * The queue is prefilled with n = min(maxN, 1e6) random keys (default 1e6);
+ * a larger maxN is capped, with a note on stderr.
+ * Then T threads, for T = 1, 2, 4, ... up to 32 (or the hardware thread count
+ * if larger), each run an equal share of OPS hold operations: try to pop one
+ * element, then push a new random key.  'engine' is one of MultiQueue,
+ * LockedBinary or LockedPairing.  Output is CSV on stdout:
+ *
+ *     engine,threads,n,ops,ns_per_op,ops_per_s
+ *
+ * ops_per_s is the combined throughput of all threads; ns_per_op is wall
+ * time divided by the total number of operations.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryPQ.h"
+#include "MultiQueuePQ.h"
+#include "PairingPQ.h"
+
+using namespace std;
+
+
+static const size_t OPS = 2000000;
+static const size_t DEFAULT_N = 1000000;
+
+// Keeps results alive so the optimizer cannot drop the work.
+static int64_t sink = 0;
+
+
+// The baseline: any engine with every call under one mutex.
+template<typename PQ>
+class Locked {
+public:
+    void push(int val) {
+        lock_guard<mutex> guard{ lock };
+        pq.push(val);
+    } // push()
+
+    bool try_pop(int &out) {
+        lock_guard<mutex> guard{ lock };
+        if (pq.empty())
+            return false;
+        out = pq.pop_value();
+        return true;
+    } // try_pop()
+
+private:
+    mutex lock;
+    PQ pq;
+}; // Locked
+
+
+// Per-thread xorshift keys.
+class KeyStream {
+public:
+    explicit KeyStream(uint64_t seed) : state{ (seed * 0x9E3779B97F4A7C15ULL) | 1 } {}
+
+    int next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return int(state >> 33);
+    } // next()
+
+private:
+    uint64_t state;
+}; // KeyStream
+
+
+template<typename QUEUE>
+double holdNs(QUEUE &queue, size_t threads, size_t ops) {
+    vector<thread> workers;
+    vector<int64_t> sums(threads);
+    const size_t share = ops / threads;
+    auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, &sums, share, t]() {
+            KeyStream keys(t + 1);
+            int64_t sum = 0;
+            int val = 0;
+            for (size_t i = 0; i < share; ++i) {
+                if (queue.try_pop(val))
+                    sum += val;
+                queue.push(keys.next());
+            } // for
+            sums[t] = sum;
+        });
+    } // for
+    for (thread &worker : workers)
+        worker.join();
+    auto elapsed = chrono::steady_clock::now() - start;
+    for (int64_t sum : sums)
+        sink += sum;
+    return double(chrono::duration_cast<chrono::nanoseconds>(elapsed).count())
+           / double(share * threads);
+} // holdNs()
+
+
+// 'make' builds a fresh queue for the given number of threads.
+template<typename MAKE>
+void benchQueue(const string &engine, size_t n, size_t maxThreads, MAKE make) {
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        auto queue = make(threads);
+        KeyStream keys(0);
+        for (size_t i = 0; i < n; ++i)
+            queue->push(keys.next());
+        double ns = holdNs(*queue, threads, OPS);
+        cout << engine << ',' << threads << ',' << n << ',' << OPS / threads * threads << ','
+             << ns << ',' << 1e9 / ns << endl;
+    } // for
+} // benchQueue()
+
+
+int main(int argc, char *argv[]) {
+    size_t n = DEFAULT_N;
+    string only;
+    if (argc > 1) {
+        const size_t maxN = size_t(strtoull(argv[1], nullptr, 10));
+        if (maxN > n)
+            cerr << "benchConcurrent: n capped at " << n << endl;
+        n = min(n, maxN);
+    }
+    if (argc > 2)
+        only = argv[2];
+    if (!only.empty() && only != "MultiQueue" && only != "LockedBinary" && only != "LockedPairing") {
+        cerr << "benchConcurrent: unknown engine " << only << endl;
+        return 1;
+    }
+    const size_t maxThreads = max<size_t>(32, thread::hardware_concurrency());
+
+    cout << "engine,threads,n,ops,ns_per_op,ops_per_s" << endl;
+    // Four shards per thread, as MultiQueuePQ.h recommends.
+    if (only.empty() || only == "MultiQueue")
+        benchQueue("MultiQueue", n, maxThreads, [](size_t threads) {
+            return make_unique<MultiQueuePQ<int>>(4 * threads);
+        });
+    if (only.empty() || only == "LockedBinary")
+        benchQueue("LockedBinary", n, maxThreads, [](size_t) {
+            return make_unique<Locked<BinaryPQ<int>>>();
+        });
+    if (only.empty() || only == "LockedPairing")
+        benchQueue("LockedPairing", n, maxThreads, [](size_t) {
+            return make_unique<Locked<PairingPQ<int>>>();
+        });
+    cerr << "checksum " << sink << endl;
+    return 0;
+} // main()
@@ -0,0 +1,690 @@
+// Project identifier: 9504853406CBAC39EE89AA3AD238AA12CA198043
+
+/*
+ * Microbenchmarks for the priority queue engines.  Build and run with
+ * 'make bench'; pass arguments with 'make bench benchPQ_ARGS="..."'.
+ *
+ *     benchPQ [maxN [engine]]
+ *
+ * Sizes run from 1e2 up to maxN (default 1e7) in powers of ten; 'engine'
+ * restricts the run to one engine by name.  Output is CSV on stdout:
+ *
+ *     engine,workload,dispatch,n,ops,ns_per_op,ops_per_s,cmp_per_op,moves_per_op
+ *
+ * dispatch is "static", "virtual" (see below) or "counted": static, on the
+ * engine with CountingStats (PQStats.h), which fills in the comparisons and
+ * element moves per op.  The last two columns are empty on other rows.
+ *
+ * Workloads (the queue holds n elements when timing starts):
+ *   push     'ops' pushes of random keys, starting over from n elements
+ *            whenever the queue reaches 2n
+ *   pop      'ops' rounds of top() and pop(), refilling the queue to n
+ *            whenever it runs empty
+ *   hold     'ops' rounds of top(), pop(), push(), so the size stays at n
+ *   update   'ops' rounds of changing 1% of the pointed-to priorities and
+ *            calling updatePriorities()
+ *   updateDirty  as 'update', but each changed element is passed to
+ *            markDirty() and updateDirty() repairs only those (Binary,
+ *            Sorted and Pairing)
+ *   updateElt  PairingPQ only: 'ops' updateElt() calls on random nodes
+ *   cancel     PairingPQ only, as a timer queue of n timers: 'ops' rounds
+ *            of cancelling a random timer (40%) or firing the earliest one
+ *            (60%), then arming a new one.  Engine "Pairing" cancels with
+ *            erase(); "PairingTombstone" marks the timer dead and skips
+ *            dead timers when firing, so they stay in the heap until then
+ *   monotone   min-queues of uint64_t keys only (engines Radix and BinaryMin,
+ *            i.e. BinaryPQ<uint64_t, greater>): 'ops' rounds of popping the
+ *            smallest key k and pushing k + a random step below 2^16, as in
+ *            Dijkstra's algorithm; the size stays at n
+ *   jobs       200-byte jobs ordered by a 64-bit deadline, earliest first
+ *            (engines Binary, Dary and Keyed, i.e. KeyedPQ with ARITY 2,
+ *            and Keyed4): as 'hold', with the popped job's deadline
+ *            advanced by a random step and the job pushed back
+ *   spill      'ops' = n: n pushes of random keys, then n pops (one op is a
+ *            push and a pop).  Engine External is ExternalPQ with a memory
+ *            budget of 1/8 of the keys, in the system temp directory;
+ *            Binary holds them all in memory
+ *   snapshot   'ops' = n, one op per element: snapshot() of a queue of n
+ *            random keys to the system temp directory (Binary, Sorted,
+ *            SortedBlocked and Pairing; engine name "Snapshot" runs only these)
+ *   restore    restore() of that image into a fresh queue, from the page
+ *            cache; 'replay' is the push_range() of the same keys into a
+ *            fresh queue that a restore replaces
+ *
+ * Each workload is written once as a template over the queue type.  Running
+ * it with a concrete engine type uses the static interface; the "virtual"
+ * rows run the hold workload through Eecs281PQ&, as code that picks an
+ * engine at run time does.
+ *
+ * Sorted is SortedPQ's flat layout and SortedBlocked its blocked layout
+ * (BlockedSorted<>, 4 KB blocks).  Binary sifts top-down and BinaryBottomUp
+ * bottom-up (BinaryPQ's SIFT parameter); both also get counted hold and
+ * update rows.
+ *
+ * Engines whose operations are linear in n (UnorderedPQ and UnorderedFastPQ
+ * pop, SortedPQ push) and every 'update' row get fewer ops at large n, so a
+ * full run stays within minutes; the op count is part of every row.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Eecs281PQ.h"
+#include "BinaryPQ.h"
+#include "DaryPQ.h"
+#include "ExternalPQ.h"
+#include "KeyedPQ.h"
+#include "PairingPQ.h"
+#include "RadixPQ.h"
+#include "SortedPQ.h"
+#include "UnorderedFastPQ.h"
+#include "UnorderedPQ.h"
+
+using namespace std;
+
+
+// Deterministic pseudo-random keys, so every engine sees the same input.
+class KeyStream {
+public:
+    explicit KeyStream(uint64_t seed) : state{ seed } {}
+
+    int next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return int(state >> 33);
+    } // next()
+
+    size_t below(size_t bound) {
+        return size_t(next()) % bound;
+    } // below()
+
+private:
+    uint64_t state;
+}; // KeyStream
+
+
+// Used for the 'update' workload, where the queue holds pointers to keys.
+struct IntPtrLess {
+    bool operator()(const int *a, const int *b) const {
+        return *a < *b;
+    }
+};
+
+
+// Comparisons and element moves per op, for the "counted" rows.
+struct OpCounts {
+    double compares;
+    double moves;
+};
+
+
+// Reset the counters of a CountingStats engine before the timed loop, and
+// turn them into per-op counts after it.  No-ops for other engines.
+template<typename PQ>
+void startCounting(const PQ &pq) {
+    if constexpr (PQ::stats_type::enabled)
+        pq.stats().reset();
+} // startCounting()
+
+template<typename PQ>
+void stopCounting(const PQ &pq, size_t ops, OpCounts *counts) {
+    if constexpr (PQ::stats_type::enabled) {
+        if (counts != nullptr)
+            *counts = OpCounts{ double(pq.stats().comparisons()) / double(ops),
+                                double(pq.stats().moves()) / double(ops) };
+    }
+    else {
+        (void)pq;
+        (void)ops;
+        (void)counts;
+    }
+} // stopCounting()
+
+
+// Keeps results alive so the optimizer cannot drop the work.
+static int64_t sink = 0;
+
+// Upper bound on element visits per row for engines with linear-time
+// operations; op counts are scaled down to stay under it.
+static const size_t LINEAR_BUDGET = 100000000;
+static const size_t DEFAULT_OPS = 1000000;
+
+
+class Stopwatch {
+public:
+    Stopwatch() : start{ chrono::steady_clock::now() } {}
+
+    double nsPer(size_t ops) const {
+        auto elapsed = chrono::steady_clock::now() - start;
+        return double(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()) / double(ops);
+    } // nsPer()
+
+private:
+    chrono::steady_clock::time_point start;
+}; // Stopwatch
+
+
+// Fill 'pq' with n random keys through one push_range() (not timed).
+template<typename PQ>
+void prefill(PQ &pq, size_t n, KeyStream &keys) {
+    vector<int> batch(n);
+    for (int &key : batch)
+        key = keys.next();
+    pq.push_range(batch.begin(), batch.end());
+} // prefill()
+
+
+// Each round starts from a fresh queue of n elements (filled untimed) and
+// pushes up to n more, so the queue stays between n and 2n elements.
+template<typename PQ>
+double pushNs(size_t n, size_t ops) {
+    KeyStream keys(1);
+    double totalNs = 0;
+    for (size_t done = 0; done < ops;) {
+        PQ pq;
+        prefill(pq, n, keys);
+        size_t round = min(n, ops - done);
+        Stopwatch timer;
+        for (size_t i = 0; i < round; ++i)
+            pq.push(keys.next());
+        totalNs += timer.nsPer(1);
+        sink += pq.top();
+        done += round;
+    } // for
+    return totalNs / double(ops);
+} // pushNs()
+
+
+// Each round refills a fresh queue to n elements (not timed) and pops up to
+// n of them, until 'ops' pops have been timed.
+template<typename PQ>
+double popNs(size_t n, size_t ops) {
+    KeyStream keys(2);
+    double totalNs = 0;
+    for (size_t done = 0; done < ops;) {
+        PQ pq;
+        prefill(pq, n, keys);
+        size_t round = min(n, ops - done);
+        Stopwatch timer;
+        for (size_t i = 0; i < round; ++i) {
+            sink += pq.top();
+            pq.pop();
+        } // for
+        totalNs += timer.nsPer(1);
+        sink += int64_t(pq.size());
+        done += round;
+    } // for
+    return totalNs / double(ops);
+} // popNs()
+
+
+template<typename PQ>
+double holdLoop(PQ &pq, size_t ops, KeyStream &keys) {
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        sink += pq.top();
+        pq.pop();
+        pq.push(keys.next());
+    } // for
+    return timer.nsPer(ops);
+} // holdLoop()
+
+
+// The hold loop behind the type-erased interface.  noinline keeps the
+// compiler from seeing the dynamic type and devirtualizing the calls.
+[[gnu::noinline]] double holdLoopVirtual(Eecs281PQ<int> &pq, size_t ops, KeyStream &keys) {
+    return holdLoop(pq, ops, keys);
+} // holdLoopVirtual()
+
+
+template<typename PQ>
+double holdNs(size_t n, size_t ops, bool virtualDispatch, OpCounts *counts = nullptr) {
+    KeyStream keys(3);
+    PQ pq;
+    prefill(pq, n, keys);
+    if (virtualDispatch)
+        return holdLoopVirtual(pq, ops, keys);
+    startCounting(pq);
+    double ns = holdLoop(pq, ops, keys);
+    stopCounting(pq, ops, counts);
+    return ns;
+} // holdNs()
+
+
+template<typename PTR_PQ>
+double updateNs(size_t n, size_t ops, OpCounts *counts = nullptr) {
+    KeyStream keys(4);
+    vector<int> values(n);
+    vector<const int *> ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = keys.next();
+        ptrs[i] = &values[i];
+    } // for
+    PTR_PQ pq(ptrs.begin(), ptrs.end());
+    const size_t changes = max<size_t>(1, n / 100);
+    startCounting(pq);
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        for (size_t c = 0; c < changes; ++c)
+            values[keys.below(n)] = keys.next();
+        pq.updatePriorities();
+    } // for
+    double ns = timer.nsPer(ops);
+    stopCounting(pq, ops, counts);
+    sink += *pq.top();
+    return ns;
+} // updateNs()
+
+
+// The 'update' workload through markDirty() and updateDirty().  Binary and
+// Sorted mark the changed pointer itself, Pairing the Node holding it.
+template<typename PTR_PQ>
+double updateDirtyNs(size_t n, size_t ops) {
+    KeyStream keys(4);
+    vector<int> values(n);
+    vector<const int *> ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = keys.next();
+        ptrs[i] = &values[i];
+    } // for
+    PTR_PQ pq(ptrs.begin(), ptrs.end());
+    const size_t changes = max<size_t>(1, n / 100);
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        for (size_t c = 0; c < changes; ++c) {
+            size_t j = keys.below(n);
+            values[j] = keys.next();
+            pq.markDirty(&values[j]);
+        } // for
+        pq.updateDirty();
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += *pq.top();
+    return ns;
+} // updateDirtyNs()
+
+
+double pairingUpdateDirtyNs(size_t n, size_t ops) {
+    using PQ = PairingPQ<const int *, IntPtrLess>;
+    KeyStream keys(4);
+    vector<int> values(n);
+    vector<PQ::Node *> nodes(n);
+    PQ pq;
+    for (size_t i = 0; i < n; ++i)
+        values[i] = keys.next();
+    for (size_t i = 0; i < n; ++i)
+        nodes[i] = pq.addNode(&values[i]);
+    const size_t changes = max<size_t>(1, n / 100);
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        for (size_t c = 0; c < changes; ++c) {
+            size_t j = keys.below(n);
+            values[j] = keys.next();
+            pq.markDirty(nodes[j]);
+        } // for
+        pq.updateDirty();
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += *pq.top();
+    return ns;
+} // pairingUpdateDirtyNs()
+
+
+double updateEltNs(size_t n, size_t ops) {
+    KeyStream keys(5);
+    PairingPQ<int64_t> pq;
+    vector<PairingPQ<int64_t>::Node *> nodes(n);
+    for (size_t i = 0; i < n; ++i)
+        nodes[i] = pq.addNode(keys.next());
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        auto node = nodes[keys.below(n)];
+        pq.updateElt(node, node->getElt() + 1 + keys.next() % 1024);
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += pq.top();
+    return ns;
+} // updateEltNs()
+
+
+// A timer for the 'cancel' workload; 'gen' tells a tombstone from the
+// live timer with the same id.
+struct Timer {
+    int64_t deadline;
+    uint32_t id;
+    uint32_t gen;
+};
+
+struct LaterTimer {
+    bool operator()(const Timer &a, const Timer &b) const {
+        return a.deadline > b.deadline;
+    }
+};
+
+static const size_t TIMER_DELAY = 1 << 20;
+static const size_t CANCEL_PERCENT = 40;
+
+
+// Timers 0 .. n-1 are always live: the id of a cancelled or fired timer is
+// reused for the one armed next.
+double cancelEraseNs(size_t n, size_t ops) {
+    KeyStream keys(7);
+    PairingPQ<Timer, LaterTimer> pq;
+    vector<PairingPQ<Timer, LaterTimer>::Node *> handles(n);
+    for (uint32_t id = 0; id < n; ++id)
+        handles[id] = pq.addNode(Timer{ int64_t(keys.below(TIMER_DELAY)), id, 0 });
+    int64_t now = 0;
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        uint32_t id;
+        if (keys.below(100) < CANCEL_PERCENT) {
+            id = uint32_t(keys.below(n));
+            pq.erase(handles[id]);
+        }
+        else {
+            Timer fired = pq.pop_value();
+            now = fired.deadline;
+            id = fired.id;
+        }
+        handles[id] = pq.addNode(Timer{ now + int64_t(keys.below(TIMER_DELAY)), id, 0 });
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += now + int64_t(pq.size());
+    return ns;
+} // cancelEraseNs()
+
+
+// The same timers and decisions as cancelEraseNs(), cancelling by bumping
+// the timer's generation and dropping stale entries as they reach the top.
+double cancelTombstoneNs(size_t n, size_t ops) {
+    KeyStream keys(7);
+    PairingPQ<Timer, LaterTimer> pq;
+    vector<uint32_t> gens(n, 0);
+    for (uint32_t id = 0; id < n; ++id)
+        pq.push(Timer{ int64_t(keys.below(TIMER_DELAY)), id, 0 });
+    int64_t now = 0;
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        uint32_t id;
+        if (keys.below(100) < CANCEL_PERCENT) {
+            id = uint32_t(keys.below(n));
+            ++gens[id];
+        }
+        else {
+            Timer fired = pq.pop_value();
+            while (fired.gen != gens[fired.id])
+                fired = pq.pop_value();
+            now = fired.deadline;
+            id = fired.id;
+        }
+        pq.push(Timer{ now + int64_t(keys.below(TIMER_DELAY)), id, gens[id] });
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += now + int64_t(pq.size());
+    return ns;
+} // cancelTombstoneNs()
+
+
+template<typename PQ>
+double monotoneNs(size_t n, size_t ops) {
+    KeyStream keys(6);
+    PQ pq;
+    vector<uint64_t> batch(n);
+    for (uint64_t &key : batch)
+        key = uint64_t(keys.next()) & 0xFFFF;
+    pq.push_range(batch.begin(), batch.end());
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        uint64_t key = pq.top();
+        pq.pop();
+        pq.push(key + (uint64_t(keys.next()) & 0xFFFF));
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += int64_t(pq.top());
+    return ns;
+} // monotoneNs()
+
+
+// A job whose priority is one small field of a large struct.
+struct Job {
+    uint64_t deadline;
+    uint64_t id;
+    char notes[184];
+};
+
+struct EarlierJob {
+    bool operator()(const Job &a, const Job &b) const {
+        return a.deadline > b.deadline;
+    }
+};
+
+struct JobDeadline {
+    uint64_t operator()(const Job &job) const {
+        return job.deadline;
+    }
+};
+
+using JobByDeadline = ByKey<JobDeadline, greater<uint64_t>>;
+
+
+template<typename PQ>
+double jobsNs(size_t n, size_t ops) {
+    KeyStream keys(8);
+    PQ pq;
+    vector<Job> batch(n);
+    for (size_t i = 0; i < n; ++i) {
+        batch[i].deadline = keys.below(TIMER_DELAY);
+        batch[i].id = i;
+        batch[i].notes[0] = char(i);
+    } // for
+    pq.push_range(batch.begin(), batch.end());
+    Stopwatch timer;
+    for (size_t i = 0; i < ops; ++i) {
+        Job job = pq.pop_value();
+        job.deadline += keys.below(TIMER_DELAY);
+        pq.push(move(job));
+    } // for
+    double ns = timer.nsPer(ops);
+    sink += int64_t(pq.top().deadline + pq.top().id);
+    return ns;
+} // jobsNs()
+
+
+// Push n keys, then pop them all; ns per push-and-pop pair.
+template<typename PQ>
+double spillNs(PQ &pq, size_t n) {
+    KeyStream keys(9);
+    Stopwatch timer;
+    for (size_t i = 0; i < n; ++i)
+        pq.push(keys.next());
+    for (size_t i = 0; i < n; ++i) {
+        sink += pq.top();
+        pq.pop();
+    } // for
+    return timer.nsPer(n);
+} // spillNs()
+
+
+void printRow(const string &engine, const string &workload, const string &dispatch,
+              size_t n, size_t ops, double nsPerOp, const OpCounts *counts = nullptr) {
+    cout << engine << ',' << workload << ',' << dispatch << ',' << n << ',' << ops << ','
+         << nsPerOp << ',' << 1e9 / nsPerOp << ',';
+    if (counts != nullptr)
+        cout << counts->compares << ',' << counts->moves;
+    else
+        cout << ',';
+    cout << endl;
+} // printRow()
+
+
+// The snapshot, restore and replay rows for one engine.
+template<typename PQ>
+void benchSnapshot(const string &engine, size_t n) {
+    const string path = "/tmp/benchPQ-snapshot";
+    KeyStream keys(10);
+    vector<int> batch(n);
+    for (int &key : batch)
+        key = keys.next();
+    PQ pq;
+    pq.push_range(batch.begin(), batch.end());
+    {
+        Stopwatch timer;
+        pq.snapshot(path);
+        printRow(engine, "snapshot", "static", n, n, timer.nsPer(n));
+    }
+    {
+        PQ restored;
+        Stopwatch timer;
+        restored.restore(path);
+        printRow(engine, "restore", "static", n, n, timer.nsPer(n));
+        sink += restored.top();
+    }
+    {
+        PQ replayed;
+        Stopwatch timer;
+        replayed.push_range(batch.begin(), batch.end());
+        printRow(engine, "replay", "static", n, n, timer.nsPer(n));
+        sink += replayed.top();
+    }
+    remove(path.c_str());
+} // benchSnapshot()
+
+
+// Op count for a row whose ops each cost O(n) when 'linear' is set.
+size_t opsFor(size_t n, bool linear) {
+    if (!linear)
+        return DEFAULT_OPS;
+    return min(DEFAULT_OPS, max<size_t>(10, LINEAR_BUDGET / n));
+} // opsFor()
+
+
+// Which workloads are linear in n for an engine.
+struct Costs {
+    bool linearPush;
+    bool linearPop;
+};
+
+
+template<typename PQ, typename PTR_PQ>
+void benchEngine(const string &engine, size_t n, Costs costs) {
+    size_t ops = opsFor(n, costs.linearPush);
+    printRow(engine, "push", "static", n, ops, pushNs<PQ>(n, ops));
+    ops = opsFor(n, costs.linearPop);
+    printRow(engine, "pop", "static", n, ops, popNs<PQ>(n, ops));
+    ops = opsFor(n, costs.linearPush || costs.linearPop);
+    printRow(engine, "hold", "static", n, ops, holdNs<PQ>(n, ops, false));
+    printRow(engine, "hold", "virtual", n, ops, holdNs<PQ>(n, ops, true));
+    ops = opsFor(n, true) / 10 + 1;
+    printRow(engine, "update", "static", n, ops, updateNs<PTR_PQ>(n, ops));
+} // benchEngine()
+
+
+// The counted hold and update rows, for engines with CountingStats.
+template<typename PQ, typename PTR_PQ>
+void benchCounted(const string &engine, size_t n) {
+    OpCounts counts;
+    size_t ops = opsFor(n, false);
+    double ns = holdNs<PQ>(n, ops, false, &counts);
+    printRow(engine, "hold", "counted", n, ops, ns, &counts);
+    ops = opsFor(n, true) / 10 + 1;
+    ns = updateNs<PTR_PQ>(n, ops, &counts);
+    printRow(engine, "update", "counted", n, ops, ns, &counts);
+} // benchCounted()
+
+
+int main(int argc, char *argv[]) {
+    size_t maxN = 10000000;
+    string only;
+    if (argc > 1)
+        maxN = size_t(strtoull(argv[1], nullptr, 10));
+    if (argc > 2)
+        only = argv[2];
+
+    cout << "engine,workload,dispatch,n,ops,ns_per_op,ops_per_s,cmp_per_op,moves_per_op" << endl;
+    for (size_t n = 100; n <= maxN; n *= 10) {
+        if (only.empty() || only == "Unordered")
+            benchEngine<UnorderedPQ<int>, UnorderedPQ<const int *, IntPtrLess>>(
+                "Unordered", n, Costs{ false, true });
+        if (only.empty() || only == "UnorderedFast")
+            benchEngine<UnorderedFastPQ<int>, UnorderedFastPQ<const int *, IntPtrLess>>(
+                "UnorderedFast", n, Costs{ false, true });
+        if (only.empty() || only == "Sorted") {
+            benchEngine<SortedPQ<int>, SortedPQ<const int *, IntPtrLess>>(
+                "Sorted", n, Costs{ true, false });
+            printRow("Sorted", "updateDirty", "static", n, opsFor(n, true) / 10 + 1,
+                     updateDirtyNs<SortedPQ<const int *, IntPtrLess>>(n, opsFor(n, true) / 10 + 1));
+        } // if
+        if (only.empty() || only == "SortedBlocked")
+            benchEngine<SortedPQ<int, less<int>, BlockedSorted<>>,
+                        SortedPQ<const int *, IntPtrLess, BlockedSorted<>>>(
+                "SortedBlocked", n, Costs{ false, false });
+        if (only.empty() || only == "Binary") {
+            benchEngine<BinaryPQ<int>, BinaryPQ<const int *, IntPtrLess>>(
+                "Binary", n, Costs{ false, false });
+            printRow("Binary", "updateDirty", "static", n, opsFor(n, true) / 10 + 1,
+                     updateDirtyNs<BinaryPQ<const int *, IntPtrLess>>(n, opsFor(n, true) / 10 + 1));
+            benchCounted<BinaryPQ<int, less<int>, TopDownSift, CountingStats>,
+                         BinaryPQ<const int *, IntPtrLess, TopDownSift, CountingStats>>("Binary", n);
+        } // if
+        if (only.empty() || only == "BinaryBottomUp") {
+            benchEngine<BinaryPQ<int, less<int>, BottomUpSift>,
+                        BinaryPQ<const int *, IntPtrLess, BottomUpSift>>(
+                "BinaryBottomUp", n, Costs{ false, false });
+            benchCounted<BinaryPQ<int, less<int>, BottomUpSift, CountingStats>,
+                         BinaryPQ<const int *, IntPtrLess, BottomUpSift, CountingStats>>("BinaryBottomUp", n);
+        } // if
+        if (only.empty() || only == "Dary")
+            benchEngine<DaryPQ<int>, DaryPQ<const int *, IntPtrLess>>(
+                "Dary", n, Costs{ false, false });
+        if (only.empty() || only == "Pairing") {
+            benchEngine<PairingPQ<int>, PairingPQ<const int *, IntPtrLess>>(
+                "Pairing", n, Costs{ false, false });
+            printRow("Pairing", "updateElt", "static", n, DEFAULT_OPS,
+                     updateEltNs(n, DEFAULT_OPS));
+            printRow("Pairing", "updateDirty", "static", n, opsFor(n, true) / 10 + 1,
+                     pairingUpdateDirtyNs(n, opsFor(n, true) / 10 + 1));
+            printRow("Pairing", "cancel", "static", n, DEFAULT_OPS,
+                     cancelEraseNs(n, DEFAULT_OPS));
+        } // if
+        if (only.empty() || only == "Pairing" || only == "PairingTombstone")
+            printRow("PairingTombstone", "cancel", "static", n, DEFAULT_OPS,
+                     cancelTombstoneNs(n, DEFAULT_OPS));
+        if (only.empty() || only == "Radix" || only == "BinaryMin") {
+            printRow("Radix", "monotone", "static", n, DEFAULT_OPS,
+                     monotoneNs<RadixPQ<uint64_t>>(n, DEFAULT_OPS));
+            printRow("BinaryMin", "monotone", "static", n, DEFAULT_OPS,
+                     monotoneNs<BinaryPQ<uint64_t, greater<uint64_t>>>(n, DEFAULT_OPS));
+        } // if
+        if (only.empty() || only == "External") {
+            ExternalPQ<int> external(ExternalBudget{ n * sizeof(int) / 8 });
+            printRow("External", "spill", "static", n, n, spillNs(external, n));
+            BinaryPQ<int> binary;
+            printRow("Binary", "spill", "static", n, n, spillNs(binary, n));
+        } // if
+        if (only.empty() || only == "Snapshot") {
+            benchSnapshot<BinaryPQ<int>>("Binary", n);
+            benchSnapshot<SortedPQ<int>>("Sorted", n);
+            benchSnapshot<SortedPQ<int, less<int>, BlockedSorted<>>>("SortedBlocked", n);
+            benchSnapshot<PairingPQ<int>>("Pairing", n);
+        } // if
+        if (only.empty() || only == "Keyed" || only == "Keyed4") {
+            printRow("Binary", "jobs", "static", n, DEFAULT_OPS,
+                     jobsNs<BinaryPQ<Job, EarlierJob>>(n, DEFAULT_OPS));
+            printRow("Dary", "jobs", "static", n, DEFAULT_OPS,
+                     jobsNs<DaryPQ<Job, EarlierJob>>(n, DEFAULT_OPS));
+            printRow("Keyed", "jobs", "static", n, DEFAULT_OPS,
+                     jobsNs<KeyedPQ<Job, JobByDeadline>>(n, DEFAULT_OPS));
+            printRow("Keyed4", "jobs", "static", n, DEFAULT_OPS,
+                     jobsNs<KeyedPQ<Job, JobByDeadline, 4>>(n, DEFAULT_OPS));
+        } // if
+    } // for
+    cerr << "checksum " << sink << endl;
+    return 0;
+} // main()
@@ -22,20 +22,65 @@
  * You do not have to submit this file, but it won't cause problems if you do.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <queue>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "Eecs281PQ.h"
+#include "AddressableBinaryPQ.h"
 #include "BinaryPQ.h"
+#include "BucketPQ.h"
+#include "DaryPQ.h"
+#include "ExternalPQ.h"
+#include "KeyedPQ.h"
+#include "MpscIngestPQ.h"
+#include "MultiQueuePQ.h"
 #include "UnorderedPQ.h"
+#include "UnorderedFastPQ.h"
 #include "PairingPQ.h"
+#include "RadixPQ.h"
+#include "SimdExtreme.h"
 #include "SortedPQ.h"
 
 using namespace std;
 
 
+// Every engine must satisfy the static interface, so that code holding the
+// concrete type gets compile-time dispatch.
+static_assert(is_static_pq<UnorderedPQ<int>>::value, "UnorderedPQ is not a static PQ");
+static_assert(is_static_pq<UnorderedFastPQ<int>>::value, "UnorderedFastPQ is not a static PQ");
+static_assert(is_static_pq<SortedPQ<int>>::value, "SortedPQ is not a static PQ");
+static_assert(is_static_pq<SortedPQ<int, std::less<int>, BlockedSorted<>>>::value,
+              "blocked SortedPQ is not a static PQ");
+static_assert(is_static_pq<BinaryPQ<int>>::value, "BinaryPQ is not a static PQ");
+static_assert(is_static_pq<DaryPQ<int, std::less<int>, 8>>::value, "DaryPQ is not a static PQ");
+static_assert(is_static_pq<KeyedPQ<int>>::value, "KeyedPQ is not a static PQ");
+static_assert(is_static_pq<ExternalPQ<int>>::value, "ExternalPQ is not a static PQ");
+static_assert(is_static_pq<PairingPQ<int>>::value, "PairingPQ is not a static PQ");
+static_assert(is_static_pq<AddressableBinaryPQ<int>>::value, "AddressableBinaryPQ is not a static PQ");
+static_assert(is_static_pq<BucketPQ<int>>::value, "BucketPQ is not a static PQ");
+static_assert(is_static_pq<RadixPQ<uint64_t>>::value, "RadixPQ is not a static PQ");
+static_assert(is_static_pq<MpscIngestPQ<BinaryPQ<int>>>::value, "MpscIngestPQ is not a static PQ");
+static_assert(!is_static_pq<Eecs281PQ<int>>::value, "Eecs281PQ should only be the virtual interface");
+
+// The default statistics policy must not cost any space.
+static_assert(sizeof(Eecs281StaticPQ<BinaryPQ<int>, int, std::less<int>>) == sizeof(Eecs281PQ<int>),
+              "NoStats should be an empty base");
+
+
 // Used to test a priority queue containing pointers to integers.
 struct IntPtrComp {
     bool operator() (const int *a, const int *b) const {
@@ -43,6 +88,13 @@ struct IntPtrComp {
     }
 };
 
+// The priority of an int * for the key-ordered engines.
+struct IntPtrKey {
+    int operator()(const int *a) const {
+        return *a;
+    }
+};
+
 
 // TODO: Make sure that you're using this-compare() properly, and everywhere
 // that you should.  Complete this function by adding a functor that compares
@@ -109,12 +161,40 @@ void testUpdatePriorities(const string &pqType) {
     else if (pqType == "Sorted") {
         pq = new SortedPQ<int *, IntPtrComp>;
     }
+    else if (pqType == "SortedBlocked") {
+        pq = new SortedPQ<int *, IntPtrComp, BlockedSorted<128>>;
+    }
     else if (pqType == "Binary") {
         pq = new BinaryPQ<int*, IntPtrComp>;
     }
+    else if (pqType == "BinaryBottomUp") {
+        pq = new BinaryPQ<int*, IntPtrComp, BottomUpSift>;
+    }
     else if (pqType == "Pairing") {
         pq = new PairingPQ<int*, IntPtrComp>;
     }
+    else if (pqType == "Dary") {
+        pq = new DaryPQ<int*, IntPtrComp>;
+    }
+    else if (pqType == "UnorderedFast") {
+        pq = new UnorderedFastPQ<int*, IntPtrComp>;
+    }
+    else if (pqType == "AddressableBinary") {
+        pq = new AddressableBinaryPQ<int*, IntPtrComp>;
+    }
+    else if (pqType == "Bucket") {
+        pq = new BucketPQ<int*, IntPtrComp, IntPtrKey>(64);
+    }
+    else if (pqType == "BucketCalendar") {
+        pq = new BucketPQ<int*, IntPtrComp, IntPtrKey>(BucketCalendar{ 8, 4 });
+    }
+    else if (pqType == "Keyed") {
+        pq = new KeyedPQ<int*, IntPtrComp>;
+    }
+    else if (pqType == "External") {
+        // Room for a few pointers, so the test spills.
+        pq = new ExternalPQ<int*, IntPtrComp>(ExternalBudget{ 64 });
+    }
     if (!pq) {
         cout << "Invalid pq pointer; did you forget to create it?" << endl;
         return;
@@ -225,10 +305,1341 @@ void testPairing(vector<int> & vec) {
 } // testPairing()
 
 
+// An element that counts every time it is copied, to check that the
+// move-aware paths never copy between push() and pop_value().
+struct CopyCounted {
+    static int copies;
+    int key;
+    string payload;
+
+    explicit CopyCounted(int k) : key{ k }, payload(64, char('a' + k % 26)) {}
+    CopyCounted(const CopyCounted &other) : key{ other.key }, payload{ other.payload } {
+        ++copies;
+    }
+    CopyCounted(CopyCounted &&) = default;
+    CopyCounted &operator=(const CopyCounted &other) {
+        ++copies;
+        key = other.key;
+        payload = other.payload;
+        return *this;
+    }
+    CopyCounted &operator=(CopyCounted &&) = default;
+};
+int CopyCounted::copies = 0;
+
+struct CopyCountedComp {
+    bool operator()(const CopyCounted &a, const CopyCounted &b) const {
+        return a.key < b.key;
+    }
+};
+
+struct CopyCountedKey {
+    int operator()(const CopyCounted &a) const {
+        return a.key;
+    }
+};
+
+
+template<typename PQ>
+void testNoCopies(const string &pqType) {
+    PQ pq;
+    CopyCounted::copies = 0;
+    for (int i = 0; i < 50; ++i) {
+        int key = (i * 17) % 50;
+        if (i % 2 == 0)
+            pq.push(CopyCounted(key));
+        else
+            pq.emplace(key);
+    } // for
+    pq.updatePriorities();
+    for (int expected = 49; expected >= 0; --expected) {
+        CopyCounted val = pq.pop_value();
+        assert(val.key == expected);
+        assert(val.payload.size() == 64);
+    } // for
+    assert(pq.empty());
+    assert(CopyCounted::copies == 0);
+    cout << "testNoCopies() succeeded on " << pqType << endl;
+} // testNoCopies()
+
+
+void testMoveSemantics() {
+    testNoCopies<UnorderedPQ<CopyCounted, CopyCountedComp>>("Unordered");
+    testNoCopies<UnorderedFastPQ<CopyCounted, CopyCountedComp>>("UnorderedFast");
+    testNoCopies<SortedPQ<CopyCounted, CopyCountedComp>>("Sorted");
+    testNoCopies<SortedPQ<CopyCounted, CopyCountedComp, BlockedSorted<64>>>("SortedBlocked");
+    testNoCopies<BinaryPQ<CopyCounted, CopyCountedComp>>("Binary");
+    testNoCopies<PairingPQ<CopyCounted, CopyCountedComp>>("Pairing");
+    testNoCopies<DaryPQ<CopyCounted, CopyCountedComp, 8>>("Dary");
+    testNoCopies<KeyedPQ<CopyCounted, ByKey<CopyCountedKey>, 4>>("Keyed");
+} // testMoveSemantics()
+
+
+// Push and pop enough elements to recycle nodes through the allocator, then
+// let the destructor tear down a non-empty heap.
+template<template<typename> class NODE_ALLOC>
+void testPairingAllocator(const string &allocType) {
+    PairingPQ<string, std::less<string>, NODE_ALLOC> pq;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 1000; ++i)
+            pq.push(string(40, char('a' + (i * 7) % 26)));
+        for (int i = 0; i < 900; ++i)
+            pq.pop();
+    } // for
+    assert(pq.size() == 300);
+    string last = pq.top();
+    while (pq.size() > 100) {
+        assert(!(last < pq.top()));
+        last = pq.pop_value();
+    } // while
+
+    PairingPQ<string, std::less<string>, NODE_ALLOC> copy;
+    copy = pq;
+    assert(copy.size() == pq.size());
+    assert(copy.top() == pq.top());
+    cout << "testPairingAllocator() succeeded with " << allocType << endl;
+} // testPairingAllocator()
+
+
+// Interleave pushes, pops and updateElt() calls, checking every top()
+// against std::priority_queue, for one pairing strategy.
+template<typename PAIRING>
+void testPairingStrategy(const string &strategy) {
+    PairingPQ<int, std::less<int>, NodeArena, PAIRING> pq;
+    std::priority_queue<int> expected;
+    unsigned int seed = 12345;
+    for (int step = 0; step < 5000; ++step) {
+        seed = seed * 1103515245 + 12345;
+        unsigned int action = (seed >> 16) % 10;
+        if (action < 6 || expected.empty()) {
+            int val = int((seed >> 8) % 1000);
+            if (action == 0) {
+                // Push a low value and immediately raise it.
+                auto node = pq.addNode(val / 2);
+                pq.updateElt(node, val);
+            }
+            else {
+                pq.push(val);
+            }
+            expected.push(val);
+        }
+        else {
+            assert(pq.top() == expected.top());
+            pq.pop();
+            expected.pop();
+        }
+        assert(pq.size() == expected.size());
+    } // for
+    while (!expected.empty()) {
+        assert(pq.pop_value() == expected.top());
+        expected.pop();
+    } // while
+    assert(pq.empty());
+    cout << "testPairingStrategy() succeeded with " << strategy << endl;
+} // testPairingStrategy()
+
+
+// Move random nodes both ways with changeElt(), from a flat heap (many root
+// children, nothing popped yet) and then interleaved with pops, checking
+// every top() against the largest value still held.
+template<typename PAIRING>
+void testPairingChangeElt(const string &strategy) {
+    using PQ = PairingPQ<int, std::less<int>, NodeArena, PAIRING>;
+    PQ pq;
+    vector<typename PQ::Node *> nodes;
+    vector<int> vals;
+    // Values are kept distinct (low digits are the id) so pops can be matched.
+    for (int id = 0; id < 2000; ++id) {
+        vals.push_back(((id * 7919) % 2000) * 10000 + id);
+        nodes.push_back(pq.addNode(vals.back()));
+    } // for
+    unsigned int seed = 777;
+    for (int step = 0; step < 20000 && !vals.empty(); ++step) {
+        seed = seed * 1103515245 + 12345;
+        size_t i = (seed >> 8) % vals.size();
+        int id = vals[i] % 10000;
+        int val = int((seed >> 4) % 5000) * 10000 + id;
+        if (step % 3 == 0)
+            pq.updateElt(nodes[i], val);
+        else
+            pq.changeElt(nodes[i], val);
+        vals[i] = val;
+        assert(pq.top() == *max_element(vals.begin(), vals.end()));
+        if (step > 5000 && step % 4 == 0) {
+            size_t top = size_t(max_element(vals.begin(), vals.end()) - vals.begin());
+            assert(pq.pop_value() == vals[top]);
+            vals.erase(vals.begin() + ptrdiff_t(top));
+            nodes.erase(nodes.begin() + ptrdiff_t(top));
+        }
+        assert(pq.size() == vals.size());
+    } // for
+    sort(vals.begin(), vals.end(), std::greater<int>());
+    for ([[maybe_unused]] int val : vals)
+        assert(pq.pop_value() == val);
+    assert(pq.empty());
+
+    // Worsening the root hands the top to its best child.
+    PQ small;
+    auto top = small.addNode(10);
+    small.push(5);
+    small.push(7);
+    small.worsenElt(top, 1);
+    assert(small.top() == 7);
+    assert(small.pop_value() == 7 && small.pop_value() == 5 && small.pop_value() == 1);
+    cout << "testPairingChangeElt() succeeded with " << strategy << endl;
+} // testPairingChangeElt()
+
+
+// Erase random nodes (including the root and nodes deep in the tree) while
+// pushing and popping, checking the heap against the values still held.
+void testPairingErase() {
+    PairingPQ<int> pq;
+    vector<PairingPQ<int>::Node *> nodes;
+    vector<int> vals;
+    unsigned int seed = 4242;
+    int next = 0;
+    for (int step = 0; step < 20000; ++step) {
+        seed = seed * 1103515245 + 12345;
+        unsigned int action = (seed >> 16) % 10;
+        if (action < 5 || vals.empty()) {
+            // Values are distinct so a pop can be matched to its node.
+            vals.push_back(int((seed >> 4) % 1000) * 100000 + next++);
+            nodes.push_back(pq.addNode(vals.back()));
+        }
+        else {
+            size_t i = (seed >> 8) % vals.size();
+            if (action < 8) {
+                pq.erase(nodes[i]);
+            }
+            else {
+                i = size_t(max_element(vals.begin(), vals.end()) - vals.begin());
+                assert(pq.pop_value() == vals[i]);
+            }
+            vals.erase(vals.begin() + ptrdiff_t(i));
+            nodes.erase(nodes.begin() + ptrdiff_t(i));
+        }
+        assert(pq.size() == vals.size());
+        if (!vals.empty())
+            assert(pq.top() == *max_element(vals.begin(), vals.end()));
+    } // for
+    for (PairingPQ<int>::Node *node : nodes)
+        pq.erase(node);
+    assert(pq.empty());
+    cout << "testPairingErase() succeeded" << endl;
+} // testPairingErase()
+
+
+// Change a few, then many (past each rebuild threshold) of the pointed-to
+// values, marking each changed element with 'mark', and check that
+// updateDirty() leaves the heap in order.
+template<typename PQ, typename MARK>
+void testUpdateDirty(PQ &pq, vector<int> &values, MARK mark, const string &pqType) {
+    unsigned int seed = 99;
+    for (size_t changes : { size_t(1), size_t(5), size_t(30), size_t(400), size_t(5000),
+                            size_t(0) }) {
+        for (size_t c = 0; c < changes; ++c) {
+            seed = seed * 1103515245 + 12345;
+            size_t i = (seed >> 8) % values.size();
+            values[i] = int((seed >> 4) % 100000) - 50000;
+            mark(i);
+            if (c % 7 == 0)
+                mark(i);
+        } // for
+        pq.updateDirty();
+        assert(*pq.top() == *max_element(values.begin(), values.end()));
+    } // for
+    vector<int> expected = values;
+    sort(expected.begin(), expected.end(), std::greater<int>());
+    for ([[maybe_unused]] int val : expected) {
+        assert(*pq.top() == val);
+        pq.pop();
+    } // for
+    assert(pq.empty());
+    cout << "testUpdateDirty() succeeded on " << pqType << endl;
+} // testUpdateDirty()
+
+
+// The value-marking engines find dirty elements by pointer identity.
+template<typename PQ>
+void testUpdateDirty(const string &pqType) {
+    vector<int> values(20000);
+    vector<int *> ptrs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = int((i * 7919) % 20000);
+        ptrs.push_back(&values[i]);
+    } // for
+    PQ pq(ptrs.begin(), ptrs.end());
+    testUpdateDirty(pq, values, [&](size_t i) { pq.markDirty(&values[i]); }, pqType);
+} // testUpdateDirty()
+
+
+void testPairingUpdateDirty() {
+    vector<int> values(20000);
+    PairingPQ<int *, IntPtrComp> pq;
+    vector<PairingPQ<int *, IntPtrComp>::Node *> nodes;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = int((i * 7919) % 20000);
+        nodes.push_back(pq.addNode(&values[i]));
+    } // for
+    // Pop and push back once so the root's children are already paired.
+    int *top = pq.top();
+    pq.pop();
+    nodes[size_t(top - &values[0])] = pq.addNode(top);
+    testUpdateDirty(pq, values, [&](size_t i) { pq.markDirty(nodes[i]); }, "Pairing");
+} // testPairingUpdateDirty()
+
+
+// Random pushes, pops and batches through blocks of 16 ints (the smallest),
+// so blocks split and empty all the time, checked against std::priority_queue.
+void testSortedBlocked() {
+    SortedPQ<int, std::less<int>, BlockedSorted<16>> pq;
+    std::priority_queue<int> expected;
+    unsigned int seed = 2024;
+    for (int step = 0; step < 20000; ++step) {
+        seed = seed * 1103515245 + 12345;
+        unsigned int action = (seed >> 16) % 20;
+        if (action < 11 || expected.empty()) {
+            int val = int((seed >> 4) % 3000);
+            pq.push(val);
+            expected.push(val);
+        }
+        else if (action == 11) {
+            // Small batches go in one by one, large ones are merged.
+            vector<int> batch((seed >> 8) % 2 == 0 ? 3 : 400);
+            for (int &val : batch) {
+                seed = seed * 1103515245 + 12345;
+                val = int((seed >> 4) % 3000);
+                expected.push(val);
+            } // for
+            pq.push_range(batch.begin(), batch.end());
+        }
+        else {
+            assert(pq.top() == expected.top());
+            assert(pq.pop_value() == expected.top());
+            expected.pop();
+        }
+        assert(pq.size() == expected.size());
+    } // for
+    while (!expected.empty()) {
+        assert(pq.pop_value() == expected.top());
+        expected.pop();
+    } // while
+    assert(pq.empty());
+
+    vector<int> vals{ 5, 3, 9, 1, 7 };
+    SortedPQ<int, std::less<int>, BlockedSorted<16>> ranged(vals.begin(), vals.end());
+    SortedPQ<int, std::less<int>, BlockedSorted<16>> copy = ranged;
+    ranged.pop();
+    assert(ranged.top() == 7 && copy.top() == 9 && copy.size() == 5);
+    cout << "testSortedBlocked() succeeded" << endl;
+} // testSortedBlocked()
+
+
+// The index the unordered engines' scalar loop would pick.
+template<typename TYPE, typename COMP>
+size_t scalarExtreme(const vector<TYPE> &data, COMP comp) {
+    size_t index = 0;
+    for (size_t i = 1; i < data.size(); ++i)
+        if (comp(data[index], data[i]))
+            index = i;
+    return index;
+} // scalarExtreme()
+
+
+// SimdExtreme must pick exactly the scalar loop's index, or give up (NONE)
+// only when allowed to: short arrays and arrays holding a NaN.  Both
+// kernels are checked directly where the CPU has them.
+template<typename TYPE, typename COMP>
+void testSimdExtremeOn(const vector<TYPE> &data) {
+    using Simd = SimdExtreme<TYPE, COMP>;
+    bool nan = false;
+    for (const TYPE &val : data)
+        nan = nan || val != val;
+    [[maybe_unused]] const size_t expected = nan ? Simd::NONE : scalarExtreme(data, COMP());
+    [[maybe_unused]] const size_t index = Simd::find(data.data(), data.size());
+    assert(index == expected || (index == Simd::NONE && data.size() < Simd::MIN_SIMD));
+#if SIMDEXTREME_X86
+    using Kernels [[maybe_unused]] = SimdExtremeKernels<TYPE, std::is_same<COMP, std::less<TYPE>>::value>;
+    if (data.size() >= Simd::MIN_SIMD) {
+        if (__builtin_cpu_supports("sse4.1"))
+            assert(Kernels::sse41(data.data(), data.size()) == expected);
+        if (__builtin_cpu_supports("avx2"))
+            assert(Kernels::avx2(data.data(), data.size()) == expected);
+    } // if
+#endif
+
+    // findBeating() against a scalar scan, with bars taken from the data.
+    COMP comp;
+    for (size_t from = 0; from < data.size(); from += 7) {
+        const TYPE bar = data[(from * 13) % data.size()];
+        size_t beating = from;
+        while (beating < data.size() && !comp(bar, data[beating]))
+            ++beating;
+        assert(Simd::findBeating(data.data(), from, data.size(), bar) == beating);
+    } // for
+} // testSimdExtremeOn()
+
+
+// Pop everything from a vectorized engine and its scalar twin, pushed the
+// same elements, and check that both pop the same sequence (NaN for NaN).
+template<typename PQ, typename SCALAR_PQ>
+void testSimdNanOrder(const vector<float> &data) {
+    PQ pq(data.begin(), data.end());
+    SCALAR_PQ scalar(data.begin(), data.end());
+    while (!scalar.empty()) {
+        [[maybe_unused]] float expected = scalar.pop_value();
+        [[maybe_unused]] float got = pq.pop_value();
+        assert(got == expected || (std::isnan(got) && std::isnan(expected)));
+    } // while
+    assert(pq.empty());
+} // testSimdNanOrder()
+
+
+void testSimdExtreme() {
+    static_assert(SimdExtreme<int, std::less<int>>::supported, "int max should vectorize");
+    static_assert(SimdExtreme<float, std::greater<float>>::supported, "float min should vectorize");
+    static_assert(!SimdExtreme<double, std::less<double>>::supported, "no double kernels");
+    static_assert(!SimdExtreme<int, IntPtrComp>::supported, "only standard comparators");
+
+    unsigned int seed = 31337;
+    for (size_t n = 0; n < 300; ++n) {
+        for (int range : { 5, 1000000 }) {
+            vector<int> ints(n);
+            vector<float> floats(n);
+            for (size_t i = 0; i < n; ++i) {
+                seed = seed * 1103515245 + 12345;
+                ints[i] = int((seed >> 4) % unsigned(2 * range)) - range;
+                floats[i] = float(ints[i]) / 8.0f;
+            } // for
+            if (n > 40) {
+                ints[n / 3] = std::numeric_limits<int>::max();
+                ints[n / 2] = std::numeric_limits<int>::min();
+                floats[n / 3] = -0.0f;
+            } // if
+            testSimdExtremeOn<int, std::less<int>>(ints);
+            testSimdExtremeOn<int, std::greater<int>>(ints);
+            testSimdExtremeOn<float, std::less<float>>(floats);
+            testSimdExtremeOn<float, std::greater<float>>(floats);
+            if (n > 0) {
+                floats[seed % n] = std::numeric_limits<float>::quiet_NaN();
+                testSimdExtremeOn<float, std::less<float>>(floats);
+                testSimdExtremeOn<float, std::greater<float>>(floats);
+            } // if
+        } // for
+    } // for
+
+    // Through the engines.
+    vector<float> vals;
+    for (int i = 0; i < 200; ++i)
+        vals.push_back(float((i * 37) % 101) - 50.5f);
+    UnorderedFastPQ<float, std::greater<float>> minPQ(vals.begin(), vals.end());
+    UnorderedPQ<float> maxPQ(vals.begin(), vals.end());
+    sort(vals.begin(), vals.end());
+    for (size_t i = 0; i < vals.size(); ++i) {
+        assert(minPQ.pop_value() == vals[i]);
+        assert(maxPQ.pop_value() == vals[vals.size() - 1 - i]);
+    } // for
+
+    // With NaNs in the array the engines fall back to the scalar scan, so
+    // they pop in the same order as with CountingStats, which never
+    // vectorizes.
+    vector<float> withNan(vals.begin(), vals.end());
+    withNan[17] = std::numeric_limits<float>::quiet_NaN();
+    withNan[150] = std::numeric_limits<float>::quiet_NaN();
+    testSimdNanOrder<UnorderedPQ<float>, UnorderedPQ<float, std::less<float>, CountingStats>>(withNan);
+    testSimdNanOrder<UnorderedFastPQ<float, std::greater<float>, 1>,
+                     UnorderedFastPQ<float, std::greater<float>, 1, CountingStats>>(withNan);
+    testSimdNanOrder<UnorderedFastPQ<float, std::greater<float>>,
+                     UnorderedFastPQ<float, std::greater<float>, 16, CountingStats>>(withNan);
+    cout << "testSimdExtreme() succeeded" << endl;
+} // testSimdExtreme()
+
+
+// Bursts of pops and pushes against std::priority_queue, for several cache
+// sizes; then check that a burst of CACHE pops costs a single scan.
+template<size_t CACHE>
+void testUnorderedFastCache() {
+    UnorderedFastPQ<int, std::less<int>, CACHE> pq;
+    std::priority_queue<int> expected;
+    unsigned int seed = 5150;
+    for (int round = 0; round < 300; ++round) {
+        seed = seed * 1103515245 + 12345;
+        size_t pushes = (seed >> 8) % 40;
+        size_t pops = (seed >> 16) % 40;
+        for (size_t i = 0; i < pushes; ++i) {
+            seed = seed * 1103515245 + 12345;
+            int val = int((seed >> 4) % 500);
+            if (i % 2 == 0)
+                pq.push(val);
+            else
+                pq.emplace(val);
+            expected.push(val);
+        } // for
+        for (size_t i = 0; i < pops && !expected.empty(); ++i) {
+            assert(pq.top() == expected.top());
+            assert(pq.pop_value() == expected.top());
+            expected.pop();
+        } // for
+        assert(pq.size() == expected.size());
+    } // for
+
+    UnorderedFastPQ<int, std::less<int>, CACHE, CountingStats> counted;
+    for (int i = 0; i < 1000; ++i)
+        counted.push((i * 7919) % 1000);
+    counted.stats().reset();
+    for (size_t i = 0; i < CACHE; ++i)
+        assert(counted.pop_value() == int(999 - i));
+    // One scan of 1000 elements, not CACHE of them.
+    assert(counted.stats().comparisons() < 1000 + 20 * CACHE * CACHE);
+    cout << "testUnorderedFastCache() succeeded with CACHE = " << CACHE << endl;
+} // testUnorderedFastCache()
+
+
+// Feed push_range() both a small batch (incremental path) and a batch larger
+// than the queue (rebuild path), through the base class interface.
+void testPushRange(Eecs281PQ<int> *pq, const string &pqType) {
+    while (!pq->empty())
+        pq->pop();
+    vector<int> expected;
+    for (int i = 0; i < 100; ++i) {
+        pq->push(i * 3);
+        expected.push_back(i * 3);
+    } // for
+    vector<int> small{ 7, 301, 2, 150 };
+    pq->push_range(small.begin(), small.end());
+    expected.insert(expected.end(), small.begin(), small.end());
+    vector<int> large;
+    for (int i = 0; i < 1000; ++i)
+        large.push_back((i * 7919) % 2003);
+    pq->push_range(large.begin(), large.end());
+    expected.insert(expected.end(), large.begin(), large.end());
+    pq->push_range(large.end(), large.end());
+
+    sort(expected.begin(), expected.end(), std::greater<int>());
+    assert(pq->size() == expected.size());
+    for ([[maybe_unused]] int val : expected) {
+        assert(pq->top() == val);
+        pq->pop();
+    } // for
+    assert(pq->empty());
+    cout << "testPushRange() succeeded on " << pqType << endl;
+} // testPushRange()
+
+
+// Pop batches of several sizes (including more than size()) through the base
+// class interface and check they come out in order.
+void testPopN(Eecs281PQ<int> *pq, const string &pqType) {
+    while (!pq->empty())
+        pq->pop();
+    vector<int> expected;
+    for (int i = 0; i < 500; ++i)
+        expected.push_back((i * 7919) % 1009);
+    pq->push_range(expected.begin(), expected.end());
+    sort(expected.begin(), expected.end(), std::greater<int>());
+
+    vector<int> popped;
+    size_t batches[] = { 0, 1, 2, 10, 37, 150 };
+    for (size_t k : batches) {
+        pq->pop_n(k, back_inserter(popped));
+        assert(popped.size() + pq->size() == expected.size());
+        pq->push(5000);
+        pq->pop_n(1, back_inserter(popped));
+        popped.pop_back();
+    } // for
+    assert(pq->top() == expected[popped.size()]);
+    pq->pop_n(1000, back_inserter(popped));
+    assert(pq->empty());
+    assert(popped == expected);
+
+    pq->push_range(expected.begin(), expected.end());
+    vector<int> drained(expected.size());
+    assert(pq->drain(drained.begin()) == drained.end());
+    assert(drained == expected);
+    assert(pq->empty());
+    cout << "testPopN() succeeded on " << pqType << endl;
+} // testPopN()
+
+
+// Fold several shards into one with merge(), including merging into and
+// from empty queues, and check the combined contents.
+template<typename PQ>
+void testMergeShards(const string &pqType) {
+    vector<int> expected;
+    PQ combined;
+    for (int shard = 0; shard < 4; ++shard) {
+        PQ other;
+        for (int i = 0; i < 50 * shard; ++i) {
+            int val = (i * 31 + shard * 7) % 211;
+            other.push(val);
+            expected.push_back(val);
+        } // for
+        combined.merge(std::move(other));
+        assert(other.empty());
+    } // for
+    PQ empty;
+    combined.merge(std::move(empty));
+    assert(combined.size() == expected.size());
+    empty.merge(std::move(combined));
+    assert(combined.empty());
+
+    sort(expected.begin(), expected.end(), std::greater<int>());
+    for ([[maybe_unused]] int val : expected)
+        assert(empty.pop_value() == val);
+    assert(empty.empty());
+    cout << "testMergeShards() succeeded on " << pqType << endl;
+} // testMergeShards()
+
+
+// Node pointers handed out by a merged-away pairing heap must stay usable.
+void testPairingMergeNodes() {
+    PairingPQ<int> left;
+    PairingPQ<int> right;
+    for (int i = 0; i < 100; ++i)
+        left.push(i);
+    auto node = right.addNode(-5);
+    for (int i = 0; i < 100; ++i)
+        right.push(i + 1000);
+    right.pop();
+    left.merge(std::move(right));
+    assert(left.size() == 200);
+    left.updateElt(node, 5000);
+    assert(left.top() == 5000);
+    cout << "testPairingMergeNodes() succeeded" << endl;
+} // testPairingMergeNodes()
+
+
+// Test the d-ary heap at several arities against a sorted copy of the input,
+// including the range-based constructor and a min-heap comparator.
+template<std::size_t ARITY>
+void testDaryArity() {
+    vector<int> vec;
+    for (int i = 0; i < 200; ++i)
+        vec.push_back((i * 37) % 101);
+
+    DaryPQ<int, std::less<int>, ARITY> pq(vec.begin(), vec.end());
+    DaryPQ<int, std::greater<int>, ARITY> minPq;
+    for (int v : vec)
+        minPq.push(v);
+    assert(pq.size() == vec.size());
+
+    vector<int> sorted = vec;
+    sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        assert(pq.top() == sorted[sorted.size() - 1 - i]);
+        assert(minPq.top() == sorted[i]);
+        pq.pop();
+        minPq.pop();
+    } // for
+    assert(pq.empty());
+    assert(minPq.empty());
+} // testDaryArity()
+
+
+void testDary() {
+    cout << "Testing d-ary heap separately" << endl;
+    testDaryArity<2>();
+    testDaryArity<4>();
+    testDaryArity<8>();
+    testDaryArity<16>();
+    testMergeShards<DaryPQ<int>>("Dary");
+    cout << "testDary() succeeded" << endl;
+} // testDary()
+
+
+// A large element ordered by a small key, the case KeyedPQ is for.
+struct Job {
+    uint64_t deadline;
+    size_t id;
+    char notes[184];
+};
+
+struct JobDeadline {
+    uint64_t operator()(const Job &job) const {
+        return job.deadline;
+    }
+};
+
+
+// Random pushes and pops of jobs, earliest deadline first, against
+// std::priority_queue on the deadlines alone.
+template<std::size_t ARITY>
+void testKeyedArity() {
+    KeyedPQ<Job, ByKey<JobDeadline, std::greater<>>, ARITY> pq;
+    priority_queue<uint64_t, vector<uint64_t>, std::greater<uint64_t>> expected;
+    unsigned int seed = 2718;
+    size_t nextId = 0;
+    for (int round = 0; round < 4000; ++round) {
+        seed = seed * 1103515245 + 12345;
+        if (expected.empty() || (seed >> 8) % 5 < 3) {
+            Job job;
+            job.deadline = (seed >> 4) % 1000;
+            job.id = nextId++;
+            job.notes[0] = char('a' + job.id % 26);
+            pq.push(job);
+            expected.push(job.deadline);
+        } // if
+        else {
+            assert(pq.topKey() == expected.top());
+            [[maybe_unused]] Job job = pq.pop_value();
+            assert(job.deadline == expected.top());
+            assert(job.notes[0] == char('a' + job.id % 26));
+            expected.pop();
+        } // else
+        assert(pq.size() == expected.size());
+        assert(pq.empty() || pq.top().deadline == pq.topKey());
+    } // for
+    while (!expected.empty()) {
+        assert(pq.top().deadline == expected.top());
+        pq.pop();
+        expected.pop();
+    } // while
+    assert(pq.empty());
+} // testKeyedArity()
+
+
+void testKeyed() {
+    cout << "Testing keyed heap separately" << endl;
+    testKeyedArity<2>();
+    testKeyedArity<4>();
+    testKeyedArity<8>();
+
+    // The iterator range constructor, push_range() and pop_n().
+    vector<int> vec;
+    for (int i = 0; i < 300; ++i)
+        vec.push_back((i * 37) % 101);
+    KeyedPQ<int, ByKey<>, 4> pq(vec.begin(), vec.begin() + 100);
+    pq.push_range(vec.begin() + 100, vec.end());
+    vector<int> popped;
+    pq.drain(back_inserter(popped));
+    sort(vec.begin(), vec.end(), std::greater<int>());
+    assert(popped == vec);
+    testMergeShards<KeyedPQ<int>>("Keyed");
+    cout << "testKeyed() succeeded" << endl;
+} // testKeyed()
+
+
+// Sift n random elements through a heap with each SIFT mode: the same pops
+// in the same order, with fewer comparisons bottom-up.
+template<typename SIFT>
+CountingStats siftCounts(const vector<int> &vec, vector<int> &popped) {
+    BinaryPQ<int, std::less<int>, SIFT, CountingStats> pq(vec.begin(), vec.end());
+    for (size_t i = 0; i < vec.size(); ++i) {
+        if (i % 3 == 0)
+            pq.push(vec[(i * 7) % vec.size()]);
+        popped.push_back(pq.pop_value());
+    } // for
+    pq.drain(back_inserter(popped));
+    return pq.stats();
+} // siftCounts()
+
+
+void testBottomUpSift() {
+    cout << "Testing bottom-up sift separately" << endl;
+    vector<int> vec;
+    unsigned int seed = 4242;
+    for (int i = 0; i < 5000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        vec.push_back(int((seed >> 8) % 100000));
+    } // for
+
+    vector<int> topDown;
+    vector<int> bottomUp;
+    [[maybe_unused]] CountingStats topDownStats = siftCounts<TopDownSift>(vec, topDown);
+    [[maybe_unused]] CountingStats bottomUpStats = siftCounts<BottomUpSift>(vec, bottomUp);
+    assert(bottomUp == topDown);
+    vector<int> expected = vec;
+    for (size_t i = 0; i < vec.size(); i += 3)
+        expected.push_back(vec[(i * 7) % vec.size()]);
+    sort(expected.begin(), expected.end());
+    sort(bottomUp.begin(), bottomUp.end());
+    assert(bottomUp == expected);
+    // Pops dominate, and a bottom-up pop compares about once per level.
+    assert(bottomUpStats.comparisons() * 10 < topDownStats.comparisons() * 7);
+
+    testMergeShards<BinaryPQ<int, std::less<int>, BottomUpSift>>("BinaryBottomUp");
+    testUpdateDirty<BinaryPQ<int *, IntPtrComp, BottomUpSift>>("BinaryBottomUp");
+    cout << "testBottomUpSift() succeeded" << endl;
+} // testBottomUpSift()
+
+
+// A record as a batch job would spill it.
+struct Record {
+    uint64_t key;
+    uint32_t id;
+};
+
+struct LaterRecord {
+    bool operator()(const Record &a, const Record &b) const {
+        return a.key > b.key;
+    }
+};
+
+
+void testExternal() {
+    cout << "Testing external-memory queue separately" << endl;
+
+    // Mixed pushes and pops against std::priority_queue, with a 4 KB budget:
+    // 256 records to a buffer, enough spills to merge runs more than once.
+    ExternalPQ<Record, LaterRecord> pq(ExternalBudget{ 4096 });
+    priority_queue<uint64_t, vector<uint64_t>, std::greater<uint64_t>> expected;
+    unsigned int seed = 8086;
+    size_t maxRuns = 0;
+    for (uint32_t round = 0; round < 40000; ++round) {
+        seed = seed * 1103515245 + 12345;
+        if (expected.empty() || (seed >> 8) % 3 != 0) {
+            Record rec{ (seed >> 4) % 100000, round };
+            pq.push(rec);
+            expected.push(rec.key);
+        } // if
+        else {
+            assert(pq.top().key == expected.top());
+            assert(pq.pop_value().key == expected.top());
+            expected.pop();
+        } // else
+        assert(pq.size() == expected.size());
+        maxRuns = max(maxRuns, pq.numRuns());
+    } // for
+    assert(maxRuns > 2);
+    while (!expected.empty()) {
+        assert(pq.pop_value().key == expected.top());
+        expected.pop();
+    } // while
+    assert(pq.empty());
+    assert(pq.numRuns() == 0);
+
+    // Many merges: 100000 records through the same 4 KB budget is over 700
+    // spills.  Merging by level rewrites each record a few times; merging
+    // every run whenever the cap is hit wrote about 25 times the input.
+    ExternalPQ<Record, LaterRecord> many(ExternalBudget{ 4096 });
+    const uint32_t manyCount = 100000;
+    for (uint32_t i = 0; i < manyCount; ++i) {
+        seed = seed * 1103515245 + 12345;
+        many.push(Record{ seed >> 4, i });
+    } // for
+    assert(many.bytesWritten() > manyCount * sizeof(Record));
+    assert(many.bytesWritten() < 6 * manyCount * sizeof(Record));
+    for ([[maybe_unused]] uint64_t prev = 0; !many.empty();) {
+        Record rec = many.pop_value();
+        assert(rec.key >= prev);
+        prev = rec.key;
+    } // for
+
+    // The range constructor and drain(), and updatePriorities() over
+    // elements that are on disk.
+    vector<int> values;
+    for (int i = 0; i < 3000; ++i)
+        values.push_back((i * 7919) % 3001);
+    vector<int *> ptrs;
+    for (int &val : values)
+        ptrs.push_back(&val);
+    ExternalPQ<int *, IntPtrComp> ptrPq(ptrs.begin(), ptrs.end(), ExternalBudget{ 1024 });
+    assert(ptrPq.numRuns() > 0);
+    // Part way into the runs' blocks, so the rebuild has to keep the rest.
+    for (int i = 0; i < 100; ++i)
+        ptrPq.pop();
+    for (size_t i = 0; i < values.size(); i += 2)
+        values[i] = -values[i];
+    ptrPq.updatePriorities();
+    vector<int *> drained;
+    ptrPq.drain(back_inserter(drained));
+    assert(drained.size() == values.size() - 100);
+    for (size_t i = 1; i < drained.size(); ++i)
+        assert(*drained[i - 1] >= *drained[i]);
+
+    // A spill into a missing directory throws, and loses nothing.
+    ExternalPQ<int> broken(ExternalBudget{ 64, "/nonexistent/ExternalPQ" });
+    [[maybe_unused]] bool threw = false;
+    try {
+        for (int i = 0; i < 100; ++i)
+            broken.push(i);
+    } // try
+    catch (const std::system_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+    assert(broken.size() == 8 && broken.top() == 7);
+    cout << "testExternal() succeeded" << endl;
+} // testExternal()
+
+
+// Snapshot a queue of PQ, restore the image into a non-empty RESTORED, and
+// check that both pop the same records in the same order.  The restored
+// queue has the same layout, so even ties come out the same.
+template<typename PQ, typename RESTORED = PQ>
+void testSnapshot(const string &pqType) {
+    cout << "Testing snapshot and restore on " << pqType << endl;
+    const string path = "/tmp/testPQ-snapshot-" + pqType;
+
+    PQ pq;
+    unsigned int seed = 6502;
+    for (uint32_t round = 0; round < 5000; ++round) {
+        seed = seed * 1103515245 + 12345;
+        if (pq.empty() || (seed >> 8) % 4 != 0)
+            pq.push(Record{ (seed >> 4) % 1000, round });
+        else
+            pq.pop();
+    } // for
+    pq.snapshot(path);
+
+    RESTORED restored;
+    restored.push(Record{ 5000, 0 });
+    restored.restore(path);
+    assert(restored.size() == pq.size());
+    while (!pq.empty()) {
+        assert(restored.top().key == pq.top().key && restored.top().id == pq.top().id);
+        restored.pop();
+        pq.pop();
+    } // while
+    assert(restored.empty());
+
+    // An empty queue round-trips too, and the restored queue still works.
+    pq.snapshot(path);
+    restored.push(Record{ 1, 1 });
+    restored.restore(path);
+    assert(restored.empty());
+    restored.push(Record{ 2, 2 });
+    restored.push(Record{ 1, 1 });
+    assert(restored.pop_value().key == 1 && restored.top().key == 2);
+
+    std::remove(path.c_str());
+    cout << "testSnapshot() succeeded on " << pqType << endl;
+} // testSnapshot()
+
+
+// Images that cannot be restored throw, and leave the queue as it was.
+void testSnapshotErrors() {
+    cout << "Testing snapshot errors" << endl;
+    const string path = "/tmp/testPQ-snapshot-errors";
+
+    BinaryPQ<Record, LaterRecord> pq;
+    pq.push(Record{ 3, 3 });
+    [[maybe_unused]] bool threw = false;
+    try {
+        pq.restore("/nonexistent/testPQ-snapshot");
+    } // try
+    catch (const std::system_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+
+    // Another engine's image.
+    SortedPQ<Record, LaterRecord> sorted;
+    sorted.push(Record{ 1, 1 });
+    sorted.snapshot(path);
+    threw = false;
+    try {
+        pq.restore(path);
+    } // try
+    catch (const std::runtime_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+
+    // Another element type.
+    BinaryPQ<int> ints;
+    ints.push(4);
+    ints.snapshot(path);
+    threw = false;
+    try {
+        pq.restore(path);
+    } // try
+    catch (const std::runtime_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+
+    // Not a snapshot at all.
+    {
+        std::ofstream garbage(path, std::ios::binary | std::ios::trunc);
+        garbage << "not a snapshot";
+    }
+    threw = false;
+    try {
+        pq.restore(path);
+    } // try
+    catch (const std::runtime_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+    assert(pq.size() == 1 && pq.top().key == 3);
+
+    // A failed snapshot leaves nothing behind.
+    threw = false;
+    try {
+        pq.snapshot("/nonexistent/testPQ-snapshot");
+    } // try
+    catch (const std::system_error &) {
+        threw = true;
+    } // catch
+    assert(threw);
+
+    std::remove(path.c_str());
+    cout << "testSnapshotErrors() succeeded" << endl;
+} // testSnapshotErrors()
+
+
+// Counts its own calls, to check that the statistics policy sees every
+// comparison the engine makes.
+struct CallCountingLess {
+    static size_t calls;
+    bool operator()(int a, int b) const {
+        ++calls;
+        return a < b;
+    }
+};
+size_t CallCountingLess::calls = 0;
+
+
+// Run a mixed workload through an engine with CountingStats and compare the
+// counters against the comparator's own count.
+template<typename PQ>
+void testStatsEngine(const string &pqType) {
+    CallCountingLess::calls = 0;
+    PQ pq;
+    vector<int> batch;
+    for (int i = 0; i < 100; ++i) {
+        pq.push((i * 37) % 101);
+        batch.push_back((i * 53) % 97);
+    } // for
+    pq.push_range(batch.begin(), batch.end());
+    [[maybe_unused]] int last = pq.top();
+    vector<int> popped;
+    pq.pop_n(20, back_inserter(popped));
+    while (!pq.empty()) {
+        assert(pq.top() <= last);
+        last = pq.pop_value();
+    } // while
+    assert(CallCountingLess::calls > 0);
+    assert(pq.stats().comparisons() == CallCountingLess::calls);
+
+    pq.stats().reset();
+    assert(pq.stats().comparisons() == 0);
+    assert(pq.stats().sifts() == 0);
+    cout << "testStats() succeeded on " << pqType << endl;
+} // testStatsEngine()
+
+
+void testStats() {
+    using Less = CallCountingLess;
+    testStatsEngine<UnorderedPQ<int, Less, CountingStats>>("Unordered");
+    testStatsEngine<UnorderedFastPQ<int, Less, 16, CountingStats>>("UnorderedFast");
+    testStatsEngine<SortedPQ<int, Less, FlatSorted, CountingStats>>("Sorted");
+    testStatsEngine<SortedPQ<int, Less, BlockedSorted<64>, CountingStats>>("SortedBlocked");
+    testStatsEngine<BinaryPQ<int, Less, TopDownSift, CountingStats>>("Binary");
+    testStatsEngine<BinaryPQ<int, Less, BottomUpSift, CountingStats>>("BinaryBottomUp");
+    testStatsEngine<DaryPQ<int, Less, 4, CountingStats>>("Dary");
+    testStatsEngine<KeyedPQ<int, ByKey<IdentityKey, Less>, 4, CountingStats>>("Keyed");
+    testStatsEngine<PairingPQ<int, Less, NodeArena, TwoPassPairing, CountingStats>>("Pairing");
+
+    // Ascending pushes into a max-heap sift every element to the root.
+    BinaryPQ<int, std::less<int>, TopDownSift, CountingStats> binary;
+    for (int i = 0; i < 8; ++i)
+        binary.push(i);
+    assert(binary.stats().sifts() == 8);
+    assert(binary.stats().maxSiftDepth() == 3);
+    assert(binary.stats().siftDepthSum() == 0 + 1 + 1 + 2 + 2 + 2 + 2 + 3);
+    assert(binary.stats().moves() == binary.stats().siftDepthSum());
+
+    PairingPQ<int, std::less<int>, NodeArena, TwoPassPairing, CountingStats> pairing;
+    for (int i = 0; i < 10; ++i)
+        pairing.push(i);
+    pairing.pop();
+    assert(pairing.stats().allocations() == 10);
+} // testStats()
+
+
+// The MultiQueue may pop out of order, but every pushed element must come
+// out exactly once, also when several threads push and pop at once.
+void testMultiQueue() {
+    MultiQueuePQ<int> single(4);
+    assert(single.shardCount() == 4);
+    for (int i = 0; i < 1000; ++i)
+        single.push(i);
+    assert(single.size() == 1000);
+    vector<int> popped;
+    int val = 0;
+    while (single.try_pop(val))
+        popped.push_back(val);
+    assert(single.empty());
+    sort(popped.begin(), popped.end());
+    for (int i = 0; i < 1000; ++i)
+        assert(popped[size_t(i)] == i);
+
+    // One shard is a single locked heap, so pops are exact.
+    MultiQueuePQ<int> locked(1);
+    assert(locked.shardCount() == 1);
+    for (int i = 0; i < 100; ++i)
+        locked.push((i * 37) % 100);
+    for (int i = 99; i >= 0; --i) {
+        assert(locked.try_pop(val));
+        assert(val == i);
+    } // for
+    assert(!locked.try_pop(val));
+
+    const int threads = 4;
+    const int perThread = 5000;
+    MultiQueuePQ<int> shared(4 * threads);
+    vector<vector<int>> results(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&shared, &results, t]() {
+            int out = 0;
+            for (int i = 0; i < perThread; ++i) {
+                shared.push(t * perThread + i);
+                if (i % 2 == 0 && shared.try_pop(out))
+                    results[size_t(t)].push_back(out);
+            } // for
+        });
+    } // for
+    for (thread &worker : workers)
+        worker.join();
+    vector<int> all;
+    for (const vector<int> &result : results)
+        all.insert(all.end(), result.begin(), result.end());
+    while (shared.try_pop(val))
+        all.push_back(val);
+    sort(all.begin(), all.end());
+    assert(all.size() == size_t(threads * perThread));
+    for (int i = 0; i < threads * perThread; ++i)
+        assert(all[size_t(i)] == i);
+    cout << "testMultiQueue() succeeded" << endl;
+} // testMultiQueue()
+
+
+// Producers push through the ring buffer while the consumer pops; every
+// element must arrive once, and a quiet queue must pop in exact order.
+template<typename PQ>
+void testMpscIngest(const string &pqType) {
+    MpscIngestPQ<PQ, 64> ordered;
+    for (int i = 0; i < 64; ++i)
+        assert(ordered.try_push((i * 37) % 64));
+    assert(!ordered.try_push(100));
+    assert(ordered.top() == 63);
+    assert(ordered.try_push(100));
+    vector<int> batch{ 64, 65, 66 };
+    ordered.push_range(batch.begin(), batch.end());
+    assert(ordered.size() == 68);
+    vector<int> popped;
+    ordered.pop_n(4, back_inserter(popped));
+    assert((popped == vector<int>{ 100, 66, 65, 64 }));
+    for (int expected = 63; expected >= 0; --expected)
+        assert(ordered.pop_value() == expected);
+    assert(ordered.empty());
+
+    const int producers = 4;
+    const int perProducer = 20000;
+    MpscIngestPQ<PQ, 256> shared;
+    vector<thread> workers;
+    for (int t = 0; t < producers; ++t) {
+        workers.emplace_back([&shared, t]() {
+            for (int i = 0; i < perProducer; ++i)
+                shared.push(t * perProducer + i);
+        });
+    } // for
+    vector<int> received;
+    while (received.size() < size_t(producers * perProducer)) {
+        if (!shared.empty())
+            received.push_back(shared.pop_value());
+        else
+            this_thread::yield();
+    } // while
+    for (thread &worker : workers)
+        worker.join();
+    assert(shared.empty());
+    sort(received.begin(), received.end());
+    for (int i = 0; i < producers * perProducer; ++i)
+        assert(received[size_t(i)] == i);
+    cout << "testMpscIngest() succeeded on " << pqType << endl;
+} // testMpscIngest()
+
+
+// Used to test RadixPQ with a key extractor.
+struct FirstOfPair {
+    uint32_t operator()(const pair<uint32_t, int> &p) const {
+        return p.first;
+    }
+};
+
+
+// Run a Dijkstra-like monotone workload through RadixPQ and a min-BinaryPQ
+// side by side, then check signed keys, a key extractor and the range
+// constructor on unordered input.
+void testRadix() {
+    RadixPQ<uint64_t> radix;
+    BinaryPQ<uint64_t, std::greater<uint64_t>> binary;
+    uint64_t seed = 12345;
+    for (int i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        radix.push(seed >> 40);
+        binary.push(seed >> 40);
+    } // for
+    for (int i = 0; i < 20000 && !binary.empty(); ++i) {
+        assert(radix.size() == binary.size());
+        assert(radix.top() == binary.top());
+        uint64_t key = radix.pop_value();
+        assert(key == binary.pop_value());
+        assert(radix.lastKey() == key);
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        for (uint64_t extra = 0; extra < (seed >> 62); ++extra) {
+            uint64_t next = key + ((seed >> (20 + extra * 8)) & 0xFFFF);
+            radix.push(next);
+            binary.push(next);
+        } // for
+    } // for
+    while (!binary.empty())
+        assert(radix.pop_value() == binary.pop_value());
+    assert(radix.empty());
+
+    vector<int> signedKeys{ 5, -3, 0, -100, 42, -3, 7 };
+    RadixPQ<int> signedPq(signedKeys.begin(), signedKeys.end());
+    sort(signedKeys.begin(), signedKeys.end());
+    for ([[maybe_unused]] int expected : signedKeys)
+        assert(signedPq.pop_value() == expected);
+
+    RadixPQ<pair<uint32_t, int>, std::greater<pair<uint32_t, int>>, FirstOfPair> keyed;
+    keyed.push({ 30, 0 });
+    keyed.push({ 10, 1 });
+    keyed.push({ 20, 2 });
+    assert(keyed.top().second == 1);
+    keyed.pop();
+    keyed.push({ 15, 3 });
+    assert(keyed.pop_value().second == 3);
+    assert(keyed.pop_value().second == 2);
+    assert(keyed.pop_value().second == 0);
+
+    // Tied keys with distinct payloads: pop_value() returns what top() named,
+    // whether the top was found in a higher bucket or already in bucket 0.
+    RadixPQ<pair<uint32_t, int>, std::greater<pair<uint32_t, int>>, FirstOfPair> ties;
+    int payload = 0;
+    for (uint32_t k = 0; k < 40; ++k) {
+        ties.push({ 5 + k / 8, payload++ });
+        ties.push({ 5 + k / 4, payload++ });
+    } // for
+    for (int i = 0; !ties.empty(); ++i) {
+        pair<uint32_t, int> expected = ties.top();
+        assert(ties.pop_value() == expected);
+        if (i % 3 == 0)
+            ties.push({ ties.lastKey(), payload++ });
+        if (!ties.empty()) {
+            expected = ties.top();
+            ties.pop();
+            if (!ties.empty())
+                assert(ties.top() != expected);
+        } // if
+    } // for
+    cout << "testRadix() succeeded" << endl;
+} // testRadix()
+
+
+// Used to test FIFO order among equal priorities.
+struct FirstOfIntPair {
+    int operator()(const pair<int, int> &p) const {
+        return p.first;
+    }
+};
+
+
+// Check FIFO order within a priority, both pop directions, bucket
+// compaction, and calendar mode against a BinaryPQ on clustered priorities
+// that sometimes jump back below the current position.
+void testBucket() {
+    BucketPQ<pair<int, int>, std::less<pair<int, int>>, FirstOfIntPair> fifo(16);
+    for (int i = 0; i < 300; ++i)
+        fifo.push({ i % 3, i });
+    for (int priority = 2; priority >= 0; --priority) {
+        for (int i = priority; i < 300; i += 3) {
+            assert(fifo.top().first == priority);
+            assert(fifo.pop_value().second == i);
+        } // for
+    } // for
+    assert(fifo.empty());
+
+    BucketPQ<int, std::greater<int>> lowest(100);
+    for (int i = 0; i < 100; ++i)
+        lowest.push((i * 37) % 100);
+    for (int i = 0; i < 100; ++i)
+        assert(lowest.pop_value() == i);
+
+    BucketPQ<uint64_t, std::greater<uint64_t>> calendar(BucketCalendar{ 32, 8 });
+    BinaryPQ<uint64_t, std::greater<uint64_t>> reference;
+    uint64_t seed = 99;
+    uint64_t now = 1000000;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t when = now + ((seed >> 33) % 200);
+        if ((seed >> 60) == 0)
+            when = now - ((seed >> 20) % 5000);
+        calendar.push(when);
+        reference.push(when);
+        if ((seed >> 40) % 3 != 0) {
+            assert(calendar.top() == reference.top());
+            now = calendar.pop_value();
+            assert(now == reference.pop_value());
+        } // if
+    } // for
+    while (!reference.empty())
+        assert(calendar.pop_value() == reference.pop_value());
+    assert(calendar.empty());
+    cout << "testBucket() succeeded" << endl;
+} // testBucket()
+
+
+// Random pushes, updates in both directions, erases and pops through
+// handles, checked against a plain list of the live elements.
+void testAddressable() {
+    AddressableBinaryPQ<int> pq;
+    vector<pair<size_t, int>> live;
+    uint64_t seed = 7;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return size_t(seed >> 33);
+    };
+    for (int step = 0; step < 20000; ++step) {
+        size_t op = next() % 10;
+        if (live.empty() || op < 4) {
+            int val = int(next() % 1000);
+            live.emplace_back(pq.pushHandle(val), val);
+        } // if
+        else if (op < 7) {
+            auto &entry = live[next() % live.size()];
+            entry.second = int(next() % 1000);
+            pq.update(entry.first, entry.second);
+        } // else if
+        else if (op < 9) {
+            size_t i = next() % live.size();
+            pq.erase(live[i].first);
+            assert(!pq.contains(live[i].first));
+            live[i] = live.back();
+            live.pop_back();
+        } // else if
+        else {
+            [[maybe_unused]] auto best = max_element(live.begin(), live.end(),
+                                    [](const pair<size_t, int> &a, const pair<size_t, int> &b) {
+                                        return a.second < b.second;
+                                    });
+            [[maybe_unused]] int popped = pq.pop_value();
+            assert(popped == best->second);
+            // Equal values may tie; drop whichever handle was popped.
+            live.erase(remove_if(live.begin(), live.end(),
+                                 [&pq](const pair<size_t, int> &entry) {
+                                     return !pq.contains(entry.first);
+                                 }),
+                       live.end());
+        } // else
+        assert(pq.size() == live.size());
+        for (size_t i = 0; i < live.size(); i += 97)
+            assert(pq.get(live[i].first) == live[i].second);
+    } // for
+    cout << "testAddressable() succeeded" << endl;
+} // testAddressable()
+
+
 int main() {
     // Basic pointer, allocate a new PQ later based on user choice.
     Eecs281PQ<int> *pq;
-    vector<string> types{ "Unordered", "Sorted", "Binary", "Pairing" };
+    vector<string> types{ "Unordered", "Sorted", "Binary", "Pairing", "Dary", "UnorderedFast",
+                          "Bucket", "BucketCalendar", "AddressableBinary", "SortedBlocked", "Keyed",
+                          "BinaryBottomUp", "External" };
     unsigned int choice;
 
     cout << "PQ tester" << endl << endl;
@@ -250,6 +1661,36 @@ int main() {
     else if (choice == 3) {
         pq = new PairingPQ<int>;
     } // else if
+    else if (choice == 4) {
+        pq = new DaryPQ<int>;
+    } // else if
+    else if (choice == 5) {
+        pq = new UnorderedFastPQ<int>;
+    } // else if
+    else if (choice == 6) {
+        // The tests in main() use priorities up to 5000.
+        pq = new BucketPQ<int>(8192);
+    } // else if
+    else if (choice == 7) {
+        pq = new BucketPQ<int>(BucketCalendar{ 64, 16 });
+    } // else if
+    else if (choice == 8) {
+        pq = new AddressableBinaryPQ<int>;
+    } // else if
+    else if (choice == 9) {
+        // Small blocks, so the tests in main() split them.
+        pq = new SortedPQ<int, std::less<int>, BlockedSorted<64>>;
+    } // else if
+    else if (choice == 10) {
+        pq = new KeyedPQ<int>;
+    } // else if
+    else if (choice == 11) {
+        pq = new BinaryPQ<int, std::less<int>, BottomUpSift>;
+    } // else if
+    else if (choice == 12) {
+        // A budget of a few ints, so the tests in main() spill and merge runs.
+        pq = new ExternalPQ<int>(ExternalBudget{ 64 });
+    } // else if
     else {
         cout << "Unknown container!" << endl << endl;
         exit(1);
@@ -257,6 +1698,33 @@ int main() {
    
     testPriorityQueue(pq, types[choice]);
     testUpdatePriorities(types[choice]);
+    testMoveSemantics();
+    testStats();
+    testPushRange(pq, types[choice]);
+    testPopN(pq, types[choice]);
+
+    if (choice == 0 || choice == 5) {
+        testSimdExtreme();
+        if (choice == 5) {
+            testUnorderedFastCache<1>();
+            testUnorderedFastCache<4>();
+            testUnorderedFastCache<16>();
+        } // if
+    } // if
+    else if (choice == 1) {
+        testMergeShards<SortedPQ<int>>("Sorted");
+        testUpdateDirty<SortedPQ<int *, IntPtrComp>>("Sorted");
+        testSnapshot<SortedPQ<Record, LaterRecord>>("Sorted");
+    } // else if
+    else if (choice == 2) {
+        testMergeShards<BinaryPQ<int>>("Binary");
+        testMultiQueue();
+        testRadix();
+        testMpscIngest<BinaryPQ<int>>("Binary");
+        testUpdateDirty<BinaryPQ<int *, IntPtrComp>>("Binary");
+        testSnapshot<BinaryPQ<Record, LaterRecord>>("Binary");
+        testSnapshotErrors();
+    } // else if
 
     if (choice == 3) {
         vector<int> vec;
@@ -266,7 +1734,48 @@ int main() {
         vec.push_back(10);
         vec.push_back(7);
         testPairing(vec);
+        testPairingAllocator<NodeArena>("NodeArena");
+        testPairingAllocator<NewDeleteNodes>("NewDeleteNodes");
+        testPairingStrategy<TwoPassPairing>("TwoPassPairing");
+        testPairingStrategy<MultipassPairing>("MultipassPairing");
+        testPairingStrategy<AuxTwoPassPairing>("AuxTwoPassPairing");
+        testPairingChangeElt<TwoPassPairing>("TwoPassPairing");
+        testPairingChangeElt<MultipassPairing>("MultipassPairing");
+        testPairingChangeElt<AuxTwoPassPairing>("AuxTwoPassPairing");
+        testPairingErase();
+        testPairingUpdateDirty();
+        testMergeShards<PairingPQ<int>>("Pairing");
+        testPairingMergeNodes();
+        testMpscIngest<PairingPQ<int>>("Pairing");
+        testSnapshot<PairingPQ<Record, LaterRecord>>("Pairing");
     } // if
+    else if (choice == 4) {
+        testDary();
+    } // else if
+    else if (choice == 6 || choice == 7) {
+        testBucket();
+    } // else if
+    else if (choice == 8) {
+        testAddressable();
+    } // else if
+    else if (choice == 9) {
+        testSortedBlocked();
+        testMergeShards<SortedPQ<int, std::less<int>, BlockedSorted<64>>>("SortedBlocked");
+        testUpdateDirty<SortedPQ<int *, IntPtrComp, BlockedSorted<256>>>("SortedBlocked");
+        testSnapshot<SortedPQ<Record, LaterRecord, BlockedSorted<256>>>("SortedBlocked");
+        testSnapshot<SortedPQ<Record, LaterRecord>, SortedPQ<Record, LaterRecord, BlockedSorted<256>>>(
+            "SortedFlatToBlocked");
+    } // else if
+    else if (choice == 10) {
+        testKeyed();
+    } // else if
+    else if (choice == 11) {
+        testBottomUpSift();
+        testSnapshot<BinaryPQ<Record, LaterRecord, BottomUpSift>>("BinaryBottomUp");
+    } // else if
+    else if (choice == 12) {
+        testExternal();
+    } // else if
 
     // Clean up!
     delete pq;